@@ -1,8 +1,10 @@
 #include <stdio.h>
+#include "pf-assignment3-task1.h"
 
-double calculateRepayment(double loan, double interestRate, int totalYears, int currentYear) {
+double repaymentSchedule(double loan, double interestRate, int totalYears, int currentYear,
+                         LoanYearSink sink, void *ctx) {
 
-    const double installment = 20000;
+    const double installment = LOAN_INSTALLMENT;
     
     if (currentYear > totalYears) {
         return 0;
@@ -21,13 +23,32 @@ double calculateRepayment(double loan, double interestRate, int totalYears, int
         //  in this case, the total repayment will still include the full installment amount
     }
     
-    //  printing the remaining loan for the current year
-    printf("Year %d: Remaining loan = %.2f\n", currentYear, loan);
+    //  reporting the remaining loan for the current year
+    if (sink) {
+        LoanYear year = { currentYear, loan };
+        sink(ctx, &year);
+    }
     
     //  recursion: total repayment = current installment + repayment for remaining years
-    return installment + calculateRepayment(loan, interestRate, totalYears, currentYear + 1);
+    return installment + repaymentSchedule(loan, interestRate, totalYears, currentYear + 1, sink, ctx);
+}
+
+void calculateRepayments(const LoanRequest *requests, double *totals, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        totals[i] = repaymentSchedule(requests[i].loan, requests[i].interestRate, requests[i].totalYears, 1, NULL, NULL);
+    }
+}
+
+static void printYear(void *ctx, const LoanYear *year) {
+    (void)ctx;
+    printf("Year %d: Remaining loan = %.2f\n", year->year, year->balance);
+}
+
+double calculateRepayment(double loan, double interestRate, int totalYears, int currentYear) {
+    return repaymentSchedule(loan, interestRate, totalYears, currentYear, printYear, NULL);
 }
 
+#ifndef PF_LIBRARY
 int main() {
 
 	double loan, interestRate;
@@ -52,6 +73,7 @@ int main() {
 
 	return 0;
 }
+#endif
 
 
 /* EXPLANATION: RECURSIVE LOAN CALCULATION
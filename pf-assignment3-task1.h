@@ -0,0 +1,43 @@
+#ifndef PF_ASSIGNMENT3_TASK1_H
+#define PF_ASSIGNMENT3_TASK1_H
+
+// Loan repayment library. Build the program without its interactive main
+// with -DPF_LIBRARY to link these functions into another program.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOAN_INSTALLMENT 20000.0
+
+typedef struct {
+    int year;
+    double balance;         //  remaining loan after this year's installment
+} LoanYear;
+
+//  receives every year of a schedule in order; ctx is the caller's own pointer
+typedef void (*LoanYearSink)(void *ctx, const LoanYear *year);
+
+typedef struct {
+    double loan;
+    double interestRate;    //  a fraction: 0.05 for 5%
+    int totalYears;
+} LoanRequest;
+
+//  total repaid over years currentYear..totalYears; each year goes to sink unless it is NULL
+double repaymentSchedule(double loan, double interestRate, int totalYears, int currentYear,
+                         LoanYearSink sink, void *ctx);
+
+//  totals[i] = total repayment for requests[i], without printing anything
+void calculateRepayments(const LoanRequest *requests, double *totals, size_t count);
+
+//  repaymentSchedule that prints each year to stdout
+double calculateRepayment(double loan, double interestRate, int totalYears, int currentYear);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,13 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "pf-assignment3-task2.h"
 
-void calculateFuel(int fuel, int consumption, int recharge, int solarBonus, int planet, int totalPlanets)
+FuelResult runFuelMission(int fuel, int consumption, int recharge, int solarBonus, int planet, int totalPlanets,
+                          FuelLegSink sink, void *ctx)
 {
 	// base case 1
     if (planet>totalPlanets)
     {
-        printf("\n MISSION COMPLETED! The spacecraft visited %d planets.\n", totalPlanets);
-        return;
+        FuelResult done = { 1, totalPlanets, fuel };
+        return done;
     }
 
     // consume fuel for the current leg
@@ -28,17 +30,48 @@ void calculateFuel(int fuel, int consumption, int recharge, int solarBonus, int
     // base case 2
     if (fuel<=0)
     {
-        printf("Planet %d: Fuel Remaining = 0\n", planet);
-        printf("\n MISSION FAILED! Fuel exhausted after Planet %d.\n", planet);
-        return;
+        FuelLeg leg = { planet, 0 };
+        if (sink) sink(ctx, &leg);
+        FuelResult failed = { 0, planet, 0 };
+        return failed;
     }
     
-    printf("Planet %d: Fuel Remaining = %d\n", planet, fuel);
+    FuelLeg leg = { planet, fuel };
+    if (sink) sink(ctx, &leg);
 
     // recursion to the next planet
-    calculateFuel(fuel, consumption, recharge, solarBonus, planet + 1, totalPlanets);
+    return runFuelMission(fuel, consumption, recharge, solarBonus, planet + 1, totalPlanets, sink, ctx);
+}
+
+void runFuelMissions(const FuelMission *missions, FuelResult *results, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const FuelMission *m = &missions[i];
+        results[i] = runFuelMission(m->fuel, m->consumption, m->recharge, m->solarBonus, 1, m->totalPlanets, NULL, NULL);
+    }
+}
+
+static void printLeg(void *ctx, const FuelLeg *leg)
+{
+    (void)ctx;
+    printf("Planet %d: Fuel Remaining = %d\n", leg->planet, leg->fuel);
 }
 
+void calculateFuel(int fuel, int consumption, int recharge, int solarBonus, int planet, int totalPlanets)
+{
+    FuelResult result = runFuelMission(fuel, consumption, recharge, solarBonus, planet, totalPlanets, printLeg, NULL);
+    if (result.completed)
+    {
+        printf("\n MISSION COMPLETED! The spacecraft visited %d planets.\n", totalPlanets);
+    }
+    else
+    {
+        printf("\n MISSION FAILED! Fuel exhausted after Planet %d.\n", result.lastPlanet);
+    }
+}
+
+#ifndef PF_LIBRARY
 int main()
 {
 	int fuel, consumption, recharge, solarBonus, totalPlanets;
@@ -62,4 +95,5 @@ int main()
 	calculateFuel(fuel, consumption, recharge, solarBonus, 1, totalPlanets);
 
 	return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef PF_ASSIGNMENT3_TASK2_H
+#define PF_ASSIGNMENT3_TASK2_H
+
+// Spacecraft fuel library. Build the program without its interactive main
+// with -DPF_LIBRARY to link these functions into another program.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int planet;
+    int fuel;               // fuel left after reaching it, 0 once exhausted
+} FuelLeg;
+
+// receives every leg of a mission in order; ctx is the caller's own pointer
+typedef void (*FuelLegSink)(void *ctx, const FuelLeg *leg);
+
+typedef struct {
+    int fuel, consumption, recharge, solarBonus, totalPlanets;
+} FuelMission;
+
+typedef struct {
+    int completed;          // 1 if every planet was reached
+    int lastPlanet;         // the last planet reached, or the one where fuel ran out
+    int fuelLeft;
+} FuelResult;
+
+// flies from `planet` to totalPlanets; each leg goes to sink unless it is NULL
+FuelResult runFuelMission(int fuel, int consumption, int recharge, int solarBonus, int planet, int totalPlanets,
+                          FuelLegSink sink, void *ctx);
+
+// results[i] = outcome of missions[i], without printing anything
+void runFuelMissions(const FuelMission *missions, FuelResult *results, size_t count);
+
+// runFuelMission that prints each leg and the outcome to stdout
+void calculateFuel(int fuel, int consumption, int recharge, int solarBonus, int planet, int totalPlanets);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,12 +1,94 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "pf-assignment3-task3.h"
 
-struct employeeInfo {
-	char name[50];
+#define BATCH_LINEAR_MAX 16     // below this many employees or ids a batch just scans
+
+int highestSalaryIndex(const struct employeeInfo emp[], int n){
+	if (n <= 0) return -1;
+	int high=0;
+	for(int i=1 ; i<n ; i++)
+	{
+		if(emp[i].salary>emp[high].salary)
+		high=i;
+	}
+	return high;
+}
+
+int findEmployeeById(const struct employeeInfo emp[], int n, int id){
+	for(int i=0 ; i<n ; i++)
+	{
+		if(emp[i].id == id) return i;
+	}
+	return -1;
+}
+
+int findEmployeeByName(const struct employeeInfo emp[], int n, const char *name){
+	for(int i=0 ; i<n ; i++)
+	{
+		if(strcmp(emp[i].name, name) == 0) return i;
+	}
+	return -1;
+}
+
+typedef struct {
 	int id;
-	char designation[50];
-	float salary;
-};
+	int index;
+} IdSlot;
+
+static int idSlotCompare(const void *a, const void *b){
+	const IdSlot *x = (const IdSlot *)a, *y = (const IdSlot *)b;
+	if (x->id != y->id) return x->id < y->id ? -1 : 1;
+	return x->index - y->index;
+}
+
+void findEmployeesById(const struct employeeInfo emp[], int n, const int *ids, int *indexes, size_t count){
+	IdSlot *slots = NULL;
+	if (n > BATCH_LINEAR_MAX && count > BATCH_LINEAR_MAX)
+		slots = (IdSlot *)malloc((size_t)n * sizeof(IdSlot));
+	if (!slots)
+	{
+		for(size_t i=0 ; i<count ; i++) indexes[i] = findEmployeeById(emp, n, ids[i]);
+		return;
+	}
+
+	// sorted by id, then index, so the first match of an id is the leftmost one
+	for(int i=0 ; i<n ; i++)
+	{
+		slots[i].id = emp[i].id;
+		slots[i].index = i;
+	}
+	qsort(slots, (size_t)n, sizeof(IdSlot), idSlotCompare);
+	for(size_t i=0 ; i<count ; i++)
+	{
+		size_t lo = 0, hi = (size_t)n;
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (slots[mid].id < ids[i]) lo = mid + 1;
+			else hi = mid;
+		}
+		indexes[i] = lo < (size_t)n && slots[lo].id == ids[i] ? slots[lo].index : -1;
+	}
+	free(slots);
+}
+
+int applySalaryBonus(struct employeeInfo emp[], int n, float threshold, EmployeeSink sink, void *ctx){
+    int updated_count = 0;
+    
+    for(int i = 0; i < n; i++)
+    {
+        if(emp[i].salary < threshold)     // using the passed threshold
+        {
+            emp[i].salary *= 1.10;        // applying 10% bonus
+            if (sink) sink(ctx, &emp[i]);
+            updated_count++;
+        }
+    }
+    return updated_count;
+}
+
 void displayEmployees(struct employeeInfo emp[], int n){
 	printf("ID\tName\t\tDesignation\tSalary\n");
 	for (int i = 0; i < n; i++) {
@@ -14,12 +96,8 @@ void displayEmployees(struct employeeInfo emp[], int n){
     }
 }
 void findHighestSalary(struct employeeInfo emp[], int n){
-	int high=0;
-	for(int i=1 ; i<n ; i++)
-	{
-		if(emp[i].salary>emp[high].salary)
-		high=i;
-	}
+	int high = highestSalaryIndex(emp, n);
+	if (high < 0) return;
 	printf("\nEmployee with Highest Salary:\n");
     printf("ID: %d\n", emp[high].id);
     printf("Name: %s\n", emp[high].name);
@@ -34,61 +112,49 @@ void searchEmployee(struct employeeInfo emp[], int n){
     printf("Enter choice: ");
     scanf("%d", &choice);
     
+    int found = -1;
     if(choice==1)
     {
     	int searchID;
     	printf("Enter Employee ID: ");
     	scanf("%d",&searchID);
-    	for(int i=0 ; i<n ; i++)
-    	{
-    		if(emp[i].id == searchID){
-    		printf("ID\tName\t\tDesignation\tSalary\n");
-    		printf("%d\t%-10s\t%-12s\t%.2f\n", emp[i].id, emp[i].name, emp[i].designation, emp[i].salary);
-    		return ;
-			}
-		}
-		printf("Employee not found\n");
+    	found = findEmployeeById(emp, n, searchID);
 	}
 	else if(choice==2)
     {
     	char searchName[50];
     	printf("Enter Employee Name: ");
         scanf("%s", searchName);
-    	for(int i=0 ; i<n ; i++)
-    	{
-    		if(strcmp(emp[i].name, searchName) == 0){
-    		printf("ID\tName\t\tDesignation\tSalary\n");
-    		printf("%d\t%-10s\t%-12s\t%.2f\n", emp[i].id, emp[i].name, emp[i].designation, emp[i].salary);
-    		return ;
-			}
-		}
-		printf("Employee not found\n");
+    	found = findEmployeeByName(emp, n, searchName);
 	}
 	else
 	{
 		printf("Invalid Choice");
+		return;
 	}
+
+	if(found == -1)
+	{
+		printf("Employee not found\n");
+		return;
+	}
+	printf("ID\tName\t\tDesignation\tSalary\n");
+	printf("%d\t%-10s\t%-12s\t%.2f\n", emp[found].id, emp[found].name, emp[found].designation, emp[found].salary);
+}
+
+static void printRaise(void *ctx, const struct employeeInfo *emp){
+    (void)ctx;
+    printf("Updated Employee %d (%s): New Salary = %.2f\n", emp->id, emp->name, emp->salary);
 }
 
 void updateSalary(struct employeeInfo emp[], int n, float threshold){
     printf("\n--- Updating Salaries (Bonus for Salary < %.2f) ---\n", threshold);
-    int updated_count = 0;
-    
-    for(int i = 0; i < n; i++)
-    {
-        if(emp[i].salary < threshold)     // using the passed threshold
-        {
-            emp[i].salary *= 1.10;        // applying 10% bonus
-            printf("Updated Employee %d (%s): New Salary = %.2f\n", 
-                   emp[i].id, emp[i].name, emp[i].salary);
-            updated_count++;
-        }
-    }
-    if (updated_count == 0) {
+    if (applySalaryBonus(emp, n, threshold, printRaise, NULL) == 0) {
         printf("No salaries were updated below the threshold.\n");
     }
 }
 
+#ifndef PF_LIBRARY
 int main()
 {
 	int n;
@@ -131,6 +197,7 @@ int main()
     
     return 0; 
 }
+#endif
 
 
 /* EXPLANATION: SALARY UPDATE BY REFERENCE
@@ -0,0 +1,47 @@
+#ifndef PF_ASSIGNMENT3_TASK3_H
+#define PF_ASSIGNMENT3_TASK3_H
+
+// Employee records library. Build the program without its interactive main
+// with -DPF_LIBRARY to link these functions into another program.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct employeeInfo {
+	char name[50];
+	int id;
+	char designation[50];
+	float salary;
+};
+
+// receives each employee a function reports on; ctx is the caller's own pointer
+typedef void (*EmployeeSink)(void *ctx, const struct employeeInfo *emp);
+
+// index of the highest salary (the first on a tie), or -1 when n is 0
+int highestSalaryIndex(const struct employeeInfo emp[], int n);
+
+// index of the first employee with this id or name, or -1
+int findEmployeeById(const struct employeeInfo emp[], int n, int id);
+int findEmployeeByName(const struct employeeInfo emp[], int n, const char *name);
+
+// indexes[i] = findEmployeeById(emp, n, ids[i]), sorting the ids once for large batches
+void findEmployeesById(const struct employeeInfo emp[], int n, const int *ids, int *indexes, size_t count);
+
+// gives a 10% bonus to every salary below threshold, reporting each raised
+// employee to sink unless it is NULL; returns how many were raised
+int applySalaryBonus(struct employeeInfo emp[], int n, float threshold, EmployeeSink sink, void *ctx);
+
+// printing versions used by the interactive program; searchEmployee reads its query from stdin
+void displayEmployees(struct employeeInfo emp[], int n);
+void findHighestSalary(struct employeeInfo emp[], int n);
+void searchEmployee(struct employeeInfo emp[], int n);
+void updateSalary(struct employeeInfo emp[], int n, float threshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
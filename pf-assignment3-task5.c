@@ -1,192 +1,1903 @@
 #define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include "pf-assignment3-task5.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #define INITIAL_CAPACITY 4
+#define SAVE_IOV_BATCH 1024
+#define OFFSET_STRIDE 1024
+#define UNDO_DEFAULT_DEPTH 100
+#define UNDO_MAX_BYTES ((size_t)64 * 1024 * 1024)
+#define SEARCH_PARALLEL_MIN_LINES 65536
+#define SEARCH_MAX_THREADS 16
+#define PAGE_LINES 4096
+#define PAGER_SCAN_CHUNK ((size_t)1 << 20)
+#define PAGER_DEFAULT_BUDGET ((size_t)64 * 1024 * 1024)
 
+/* Line text lives in size-class slabs: classes are powers of two from
+ * ARENA_MIN_BLOCK to ARENA_MAX_BLOCK bytes (header included), each carved
+ * out of ARENA_SLAB_SIZE chunks. Longer lines get a dedicated chunk. */
+#define ARENA_SLAB_SIZE (64 * 1024)
+#define ARENA_LARGE UINT32_MAX
+
+static void oom_exit(const char *msg)
+{
+    if (msg) perror(msg);
+    else perror("Out of memory");
+    exit(EXIT_FAILURE);
+}
+
+void arenaInit(LineArena *a)
+{
+    memset(a, 0, sizeof(*a));
+}
+
+static void arenaLink(LineArena *a, ArenaChunk *c)
+{
+    c->prev = NULL;
+    c->next = a->chunks;
+    if (a->chunks) a->chunks->prev = c;
+    a->chunks = c;
+}
+
+/* Returns a block able to hold n bytes (terminator included). */
+char *arenaAlloc(LineArena *a, size_t n)
+{
+    size_t total = n + sizeof(ArenaBlock);
+    ArenaBlock *b;
+
+    a->lineAllocs++;
+    if (total > ((size_t)1 << ARENA_MAX_SHIFT)) {
+        ArenaChunk *c = malloc(sizeof(ArenaChunk) + total);
+        if (!c) oom_exit("malloc in arenaAlloc");
+        arenaLink(a, c);
+        a->largeAllocs++;
+        a->bytesReserved += sizeof(ArenaChunk) + total;
+        b = (ArenaBlock *)(c + 1);
+        b->cap = (uint32_t)n;
+        b->cls = ARENA_LARGE;
+        return (char *)(b + 1);
+    }
+
+    unsigned cls = 0;
+    while (((size_t)1 << (cls + ARENA_MIN_SHIFT)) < total) cls++;
+    size_t blockSize = (size_t)1 << (cls + ARENA_MIN_SHIFT);
+
+    if (a->freeList[cls]) {
+        void *p = a->freeList[cls];
+        a->freeList[cls] = *(void **)p;
+        return p;
+    }
+    if (a->left[cls] < blockSize) {
+        ArenaChunk *c = malloc(ARENA_SLAB_SIZE);
+        if (!c) oom_exit("malloc in arenaAlloc");
+        arenaLink(a, c);
+        a->slabAllocs++;
+        a->bytesReserved += ARENA_SLAB_SIZE;
+        a->cursor[cls] = (char *)(c + 1);
+        a->left[cls] = ARENA_SLAB_SIZE - sizeof(ArenaChunk);
+    }
+    b = (ArenaBlock *)a->cursor[cls];
+    a->cursor[cls] += blockSize;
+    a->left[cls] -= blockSize;
+    b->cap = (uint32_t)(blockSize - sizeof(ArenaBlock));
+    b->cls = cls;
+    return (char *)(b + 1);
+}
+
+size_t arenaCapacity(const char *p)
+{
+    return ((const ArenaBlock *)p - 1)->cap;
+}
+
+void arenaFree(LineArena *a, char *p)
+{
+    if (!p) return;
+    ArenaBlock *b = (ArenaBlock *)p - 1;
+
+    a->lineFrees++;
+    if (b->cls == ARENA_LARGE) {
+        ArenaChunk *c = (ArenaChunk *)b - 1;
+        if (c->prev) c->prev->next = c->next;
+        else a->chunks = c->next;
+        if (c->next) c->next->prev = c->prev;
+        a->bytesReserved -= sizeof(ArenaChunk) + sizeof(ArenaBlock) + b->cap;
+        a->sysFrees++;
+        free(c);
+        return;
+    }
+    *(void **)p = a->freeList[b->cls];
+    a->freeList[b->cls] = p;
+}
+
+/* Drops every line at once; counters survive so the totals stay comparable. */
+void arenaReleaseAll(LineArena *a)
+{
+    ArenaChunk *c = a->chunks;
+    while (c) {
+        ArenaChunk *next = c->next;
+        free(c);
+        a->sysFrees++;
+        c = next;
+    }
+    a->chunks = NULL;
+    a->bytesReserved = 0;
+    for (unsigned i = 0; i < ARENA_CLASSES; ++i) {
+        a->cursor[i] = NULL;
+        a->left[i] = 0;
+        a->freeList[i] = NULL;
+    }
+}
+
+char *arenaStrdup(LineArena *a, const char *text, size_t len)
+{
+    char *copy = arenaAlloc(a, len + 1);
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void printArenaStats(const LineArena *a)
+{
+    printf("Line allocations: %zu, line frees: %zu\n", a->lineAllocs, a->lineFrees);
+    printf("System malloc calls: %zu (%zu slabs, %zu large lines), free calls: %zu, reserved: %zu bytes\n",
+           a->slabAllocs + a->largeAllocs, a->slabAllocs, a->largeAllocs, a->sysFrees, a->bytesReserved);
+}
+    
+void initEditor(Editor *ed)
+{
+    arenaInit(&ed->arena);
+    ed->size = 0;
+    ed->capacity = INITIAL_CAPACITY;
+    ed->lines = calloc(ed->capacity, sizeof(Line));
+    if (!ed->lines) oom_exit("malloc in initEditor"); 
+    ed->map = NULL;
+    ed->mapLen = 0;
+    ed->path[0] = '\0';
+    ed->diskCanonical = 0;
+    ed->dirtyFrom = SIZE_MAX;
+    ed->dirtyTo = 0;
+    ed->layoutShifted = 0;
+    ed->lineOffsets = NULL;
+    ed->offsetCap = 0;
+    memset(&ed->history, 0, sizeof(ed->history));
+    ed->history.depth = UNDO_DEFAULT_DEPTH;
+    ed->changes = 0;
+    ed->pager = NULL;
+    ed->pagerBudget = PAGER_DEFAULT_BUDGET;
+    memset(&ed->autosave, 0, sizeof(ed->autosave));
+    pthread_mutex_init(&ed->autosave.lock, NULL);
+    pthread_cond_init(&ed->autosave.wake, NULL);
+    pthread_cond_init(&ed->autosave.idle, NULL);
+}
+
+/* Records that lines [first, last) changed; shifted means later lines moved on disk too. */
+static void markDirty(Editor *ed, size_t first, size_t last, int shifted)
+{
+    if (first < ed->dirtyFrom) ed->dirtyFrom = first;
+    if (last > ed->dirtyTo) ed->dirtyTo = last;
+    if (shifted) ed->layoutShifted = 1;
+    ed->changes++;
+}
+
+/* The buffer now matches filename: byte for byte when canonical, else in content only. */
+static void markClean(Editor *ed, const char *filename, const struct stat *st, int canonical)
+{
+    if (filename != ed->path) snprintf(ed->path, sizeof(ed->path), "%s", filename);
+    ed->diskStat = *st;
+    ed->diskCanonical = canonical;
+    ed->dirtyFrom = SIZE_MAX;
+    ed->dirtyTo = 0;
+    ed->layoutShifted = 0;
+}
+
+/* Refills the offset index from line first on, once the buffer matches the
+ * file again. Entries up to first still hold, since nothing before the first
+ * dirty line moved. */
+static void indexOffsets(Editor *ed, size_t first)
+{
+    size_t need = ed->size / OFFSET_STRIDE + 1;
+    if (need > ed->offsetCap) {
+        off_t *tmp = realloc(ed->lineOffsets, need * sizeof(off_t));
+        if (!tmp) oom_exit("realloc in indexOffsets");
+        ed->lineOffsets = tmp;
+        ed->offsetCap = need;
+    }
+    size_t i = first / OFFSET_STRIDE * OFFSET_STRIDE;
+    off_t offset = i > 0 ? ed->lineOffsets[i / OFFSET_STRIDE] : 0;
+    for (; i < ed->size; ++i) {
+        if (i % OFFSET_STRIDE == 0) ed->lineOffsets[i / OFFSET_STRIDE] = offset;
+        offset += (off_t)ed->lines[i].len + 1;
+    }
+    if (i % OFFSET_STRIDE == 0) ed->lineOffsets[i / OFFSET_STRIDE] = offset;
+}
+
+static off_t lineOffset(const Editor *ed, size_t index)
+{
+    size_t i = index / OFFSET_STRIDE * OFFSET_STRIDE;
+    off_t offset = ed->lineOffsets[i / OFFSET_STRIDE];
+    for (; i < index; ++i) offset += (off_t)ed->lines[i].len + 1;
+    return offset;
+}
+
+/* Lines loaded with 'lm' point straight into the mapping until edited. */
+static int isMappedText(const Editor *ed, const char *text)
+{
+    return ed->map && text >= ed->map && text < ed->map + ed->mapLen;
+}
+
+static void releaseText(Editor *ed, char *text)
+{
+    if (isMappedText(ed, text)) return;
+    Autosave *as = &ed->autosave;
+    if (!as->busy) {
+        arenaFree(&ed->arena, text);
+        return;
+    }
+    if (as->deferredCount == as->deferredCap) {
+        size_t newCap = as->deferredCap ? as->deferredCap * 2 : 256;
+        char **tmp = realloc(as->deferred, newCap * sizeof(char *));
+        if (!tmp) oom_exit("realloc in releaseText");
+        as->deferred = tmp;
+        as->deferredCap = newCap;
+    }
+    as->deferred[as->deferredCount++] = text;
+}
+
+/* Called with the lock held before the arena or the mapping goes away. */
+static void waitForAutosave(Editor *ed)
+{
+    while (ed->autosave.busy) pthread_cond_wait(&ed->autosave.idle, &ed->autosave.lock);
+}
+
+/* Called with the lock held before the line table changes. While an autosave
+ * is writing the table it snapshotted, the editor switches to its own copy;
+ * the autosave thread frees the old table when it is done. */
+static void unshareLines(Editor *ed)
+{
+    if (!ed->autosave.busy || ed->lines != ed->autosave.snapLines) return;
+    Line *copy = malloc(ed->capacity * sizeof(Line));
+    if (!copy) oom_exit("malloc in unshareLines");
+    memcpy(copy, ed->lines, ed->size * sizeof(Line));
+    memset(&copy[ed->size], 0, (ed->capacity - ed->size) * sizeof(Line));
+    ed->lines = copy;
+}
+
+static void resetHistory(UndoHistory *h);
+void closePager(Editor *ed);
+static void pagerInsert(Editor *ed, size_t index, Line line);
+static void pagerDelete(Editor *ed, size_t index);
+static int pagerLoad(Editor *ed, Window *w);
+static int pagerSave(Editor *ed, const char *filename);
+
+size_t bufferLines(const Editor *ed)
+{
+    return ed->pager ? ed->pager->totalLines : ed->size;
+}
+
+static void unmapFile(Editor *ed)
+{
+    if (ed->map) munmap(ed->map, ed->mapLen);
+    ed->map = NULL;
+    ed->mapLen = 0;
+}
+
+void freeAll(Editor *ed)
+{
+    if (!ed) return;
+    waitForAutosave(ed);
+    closePager(ed);
+    arenaReleaseAll(&ed->arena);
+    unmapFile(ed);
+    resetHistory(&ed->history);
+    free(ed->history.recs);
+    ed->history.recs = NULL;
+    ed->history.cap = 0;
+    free(ed->lines);
+    ed->lines = NULL;
+    ed->size = 0;
+    ed->capacity = 0;
+    free(ed->lineOffsets);
+    ed->lineOffsets = NULL;
+    ed->offsetCap = 0;
+    free(ed->autosave.deferred);
+    ed->autosave.deferred = NULL;
+    ed->autosave.deferredCap = 0;
+}
+void ensureCapacity(Editor *ed, size_t minCap)
+{
+    if (ed->capacity >= minCap) return;
+
+    size_t newCap = ed->capacity ? ed->capacity : 1;
+    while (newCap < minCap) newCap <<= 1;
+
+    unshareLines(ed);
+    Line *tmp = realloc(ed->lines, newCap * sizeof(Line));
+    if (!tmp) oom_exit("realloc");
+    ed->lines = tmp;
+
+    memset(&ed->lines[ed->capacity], 0, (newCap - ed->capacity) * sizeof(Line));
+    ed->capacity = newCap;
+}
+
+
+/* Moves a line into the table without copying it. */
+static void spliceIn(Editor *ed, size_t index, Line line)
+{
+    ensureCapacity(ed, ed->size + 1);
+    unshareLines(ed);
+    markDirty(ed, index, index + 1, 1);
+
+    if (index < ed->size) {
+        memmove(&ed->lines[index + 1], &ed->lines[index],
+                (ed->size - index) * sizeof(Line));
+    }
+    ed->lines[index] = line;
+    ed->size++;
+}
+
+/* Takes a line out of the table; the caller now owns its text. */
+static Line spliceOut(Editor *ed, size_t index)
+{
+    Line line = ed->lines[index];
+    unshareLines(ed);
+    markDirty(ed, index, index, 1);
+    if (index + 1 < ed->size) {
+        memmove(&ed->lines[index], &ed->lines[index + 1],
+                (ed->size - index - 1) * sizeof(Line));
+    }
+    ed->size--;
+    ed->lines[ed->size].text = NULL; 
+    ed->lines[ed->size].len = 0;
+    return line;
+}
+
+static void swapLine(Editor *ed, size_t index, Line *other)
+{
+    Line cur = ed->lines[index];
+    unshareLines(ed);
+    markDirty(ed, index, index + 1, cur.len != other->len);
+    ed->lines[index] = *other;
+    *other = cur;
+}
+
+/* A record holds the text of its line while that line is out of the buffer:
+ * deletes on the undo side, inserts on the redo side, replaces always. */
+static int recordOwnsText(const UndoRecord *r, int redoSide)
+{
+    return r->kind == UNDO_REPLACE || (r->kind == UNDO_DELETE) != redoSide;
+}
+
+/* What a record adds to history.bytes: text still in the buffer is not counted. */
+static size_t recordBytes(const UndoRecord *r, int redoSide)
+{
+    return sizeof(UndoRecord) + (recordOwnsText(r, redoSide) ? r->line.len : 0);
+}
+
+static void dropRecord(Editor *ed, UndoRecord *r, int redoSide)
+{
+    if (recordOwnsText(r, redoSide)) releaseText(ed, r->line.text);
+    ed->history.bytes -= recordBytes(r, redoSide);
+}
+
+static void dropRedo(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    while (h->end > h->undoEnd) dropRecord(ed, &h->recs[--h->end], 1);
+}
+
+static void dropOldestGroup(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    size_t group = h->recs[h->start].group;
+    while (h->start < h->undoEnd && h->recs[h->start].group == group) {
+        dropRecord(ed, &h->recs[h->start++], 0);
+    }
+    h->undoGroups--;
+}
+
+static void trimHistory(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    if (h->depth == 0) {
+        dropRedo(ed);
+        while (h->undoGroups > 0) dropOldestGroup(ed);
+        return;
+    }
+    while (h->undoGroups > 1 && (h->undoGroups > h->depth || h->bytes > UNDO_MAX_BYTES)) {
+        dropOldestGroup(ed);
+    }
+}
+
+/* Drops the log without touching its text, for when the arena is released anyway. */
+static void resetHistory(UndoHistory *h)
+{
+    h->start = h->undoEnd = h->end = 0;
+    h->undoGroups = 0;
+    h->bytes = 0;
+}
+
+/* Edits made between begin and end are undone and redone as one step. */
+void historyBeginGroup(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    if (h->openDepth++ == 0) h->curGroup = ++h->groupSeq;
+}
+
+void historyEndGroup(Editor *ed)
+{
+    if (ed->history.openDepth > 0 && --ed->history.openDepth == 0) trimHistory(ed);
+}
+
+static void recordEdit(Editor *ed, UndoKind kind, size_t index, Line line)
+{
+    UndoHistory *h = &ed->history;
+    if (h->depth == 0) {
+        if (kind != UNDO_INSERT) releaseText(ed, line.text);
+        return;
+    }
+    dropRedo(ed);
+
+    size_t group = h->openDepth ? h->curGroup : ++h->groupSeq;
+    if (h->undoEnd == h->start || h->recs[h->undoEnd - 1].group != group) h->undoGroups++;
+
+    if (h->end == h->cap) {
+        if (h->start > 0 && h->start >= h->cap / 2) {
+            memmove(h->recs, &h->recs[h->start], (h->end - h->start) * sizeof(UndoRecord));
+            h->undoEnd -= h->start;
+            h->end -= h->start;
+            h->start = 0;
+        } else {
+            size_t newCap = h->cap ? h->cap * 2 : 64;
+            UndoRecord *tmp = realloc(h->recs, newCap * sizeof(UndoRecord));
+            if (!tmp) oom_exit("realloc in recordEdit");
+            h->recs = tmp;
+            h->cap = newCap;
+        }
+    }
+    UndoRecord *r = &h->recs[h->end++];
+    r->kind = kind;
+    r->group = group;
+    r->index = index;
+    r->line = line;
+    h->undoEnd = h->end;
+    h->bytes += recordBytes(r, 0);
+
+    if (h->openDepth == 0) trimHistory(ed);
+}
+
+void setHistoryDepth(Editor *ed, size_t depth)
+{
+    ed->history.depth = depth;
+    trimHistory(ed);
+}
+
+/* Reverts the most recent command; returns 0 if there was nothing to undo. */
+int undoEdit(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    if (h->undoEnd == h->start) return 0;
+
+    size_t group = h->recs[h->undoEnd - 1].group;
+    while (h->undoEnd > h->start && h->recs[h->undoEnd - 1].group == group) {
+        UndoRecord *r = &h->recs[--h->undoEnd];
+        h->bytes -= recordBytes(r, 0);
+        if (r->kind == UNDO_INSERT) r->line = spliceOut(ed, r->index);
+        else if (r->kind == UNDO_DELETE) spliceIn(ed, r->index, r->line);
+        else swapLine(ed, r->index, &r->line);
+        h->bytes += recordBytes(r, 1);
+    }
+    h->undoGroups--;
+    return 1;
+}
+
+int redoEdit(Editor *ed)
+{
+    UndoHistory *h = &ed->history;
+    if (h->undoEnd == h->end) return 0;
+
+    size_t group = h->recs[h->undoEnd].group;
+    while (h->undoEnd < h->end && h->recs[h->undoEnd].group == group) {
+        UndoRecord *r = &h->recs[h->undoEnd++];
+        h->bytes -= recordBytes(r, 1);
+        if (r->kind == UNDO_INSERT) spliceIn(ed, r->index, r->line);
+        else if (r->kind == UNDO_DELETE) r->line = spliceOut(ed, r->index);
+        else swapLine(ed, r->index, &r->line);
+        h->bytes += recordBytes(r, 0);
+    }
+    h->undoGroups++;
+    return 1;
+}
+
+void insertLine(Editor *ed, size_t index, const char *text)
+{
+    if (index > bufferLines(ed)) {
+        fprintf(stderr, "insertLine: invalid index %zu (size %zu)\n", index, bufferLines(ed));
+        return;
+    }
+    Line line;
+    line.len = strlen(text);
+    line.text = arenaStrdup(&ed->arena, text, line.len);
+    if (ed->pager) {
+        pagerInsert(ed, index, line);
+        return;
+    }
+    spliceIn(ed, index, line);
+    recordEdit(ed, UNDO_INSERT, index, line);
+}
+
+void deleteLine(Editor *ed, size_t index)
+{
+    if (index >= bufferLines(ed)) {
+        fprintf(stderr, "deleteLine: invalid index %zu (size %zu)\n", index, bufferLines(ed));
+        return;
+    }
+    if (ed->pager) {
+        pagerDelete(ed, index);
+        return;
+    }
+    recordEdit(ed, UNDO_DELETE, index, spliceOut(ed, index));
+}
+
+/* Inserts count already-allocated lines at index with a single shift of the table. */
+void insertLines(Editor *ed, size_t index, const Line *lines, size_t count)
+{
+    if (index > bufferLines(ed)) {
+        fprintf(stderr, "insertLines: invalid index %zu (size %zu)\n", index, bufferLines(ed));
+        return;
+    }
+    if (ed->pager) {
+        for (size_t k = 0; k < count; ++k) pagerInsert(ed, index + k, lines[k]);
+        return;
+    }
+    ensureCapacity(ed, ed->size + count);
+    unshareLines(ed);
+    markDirty(ed, index, index + count, 1);
+    if (index < ed->size) {
+        memmove(&ed->lines[index + count], &ed->lines[index],
+                (ed->size - index) * sizeof(Line));
+    }
+    memcpy(&ed->lines[index], lines, count * sizeof(Line));
+    ed->size += count;
+
+    historyBeginGroup(ed);
+    for (size_t k = 0; k < count; ++k) recordEdit(ed, UNDO_INSERT, index + k, lines[k]);
+    historyEndGroup(ed);
+}
+
+void deleteLines(Editor *ed, size_t index, size_t count)
+{
+    if (index > bufferLines(ed) || count > bufferLines(ed) - index) {
+        fprintf(stderr, "deleteLines: invalid range %zu+%zu (size %zu)\n", index, count, bufferLines(ed));
+        return;
+    }
+    if (ed->pager) {
+        for (size_t k = 0; k < count; ++k) pagerDelete(ed, index);
+        return;
+    }
+    historyBeginGroup(ed);
+    for (size_t k = 0; k < count; ++k) recordEdit(ed, UNDO_DELETE, index, ed->lines[index + k]);
+    historyEndGroup(ed);
+
+    unshareLines(ed);
+    markDirty(ed, index, index, 1);
+    memmove(&ed->lines[index], &ed->lines[index + count],
+            (ed->size - index - count) * sizeof(Line));
+    ed->size -= count;
+    memset(&ed->lines[ed->size], 0, count * sizeof(Line));
+}
+
+size_t visitLines(Editor *ed, size_t first, size_t last, LineSink sink, void *ctx)
+{
+    size_t total = bufferLines(ed);
+    if (first < 1) first = 1;
+    if (last > total) last = total;
+    size_t visited = 0;
+    if (!ed->pager) {
+        for (size_t i = first; i <= last; ++i) {
+            sink(ctx, i, ed->lines[i - 1].text, ed->lines[i - 1].len);
+            visited++;
+        }
+        return visited;
+    }
+    /* paged: skip windows before first without reading them */
+    size_t base = 0;
+    for (size_t i = 0; i < ed->pager->winCount && base < last; ++i) {
+        Window *w = &ed->pager->wins[i];
+        if (base + w->count < first) {
+            base += w->count;
+            continue;
+        }
+        if (pagerLoad(ed, w) != 0) break;
+        for (size_t k = 0; k < w->count && base + k < last; ++k) {
+            if (base + k + 1 < first) continue;
+            sink(ctx, base + k + 1, w->lines[k].text, w->lines[k].len);
+            visited++;
+        }
+        base += w->count;
+    }
+    return visited;
+}
+
+static void printLine(void *ctx, size_t number, const char *text, size_t len)
+{
+    (void)ctx;
+    printf("%zu: %.*s\n", number, (int)len, text);
+}
+
+void printAllLines(Editor *ed)
+{
+    if (ed->pager) printf("--- Buffer Contents (%zu lines, paged) ---\n", ed->pager->totalLines);
+    else printf("--- Buffer Contents (%zu lines, capacity %zu) ---\n", ed->size, ed->capacity);
+    visitLines(ed, 1, SIZE_MAX, printLine, NULL);
+    printf("-----------------------------------\n");
+}
+void shrinkToFit(Editor *ed)
+{
+    if (ed->size == ed->capacity) return;
+    unshareLines(ed);
+    
+    if (ed->size == 0) {
+        Line *tmp = realloc(ed->lines, INITIAL_CAPACITY * sizeof(Line));
+        if (!tmp) oom_exit("realloc (shrink to fit zero)");
+        ed->lines = tmp;
+        memset(ed->lines, 0, INITIAL_CAPACITY * sizeof(Line));
+        ed->capacity = INITIAL_CAPACITY;
+        return;
+    }
+
+    Line *tmp = realloc(ed->lines, ed->size * sizeof(Line));
+    if (!tmp) oom_exit("realloc");
+    ed->lines = tmp;
+    ed->capacity = ed->size;
+}
+
+
+static int writeFully(int fd, struct iovec *iov, int cnt)
+{
+    while (cnt > 0) {
+        ssize_t n = writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+/* Writes lines [first, last) at the current offset of fd in writev batches.
+ * Untouched mapped lines are still followed by their own newline and by the
+ * next line, so a clean stretch of the mapping goes out as a single iovec. */
+static int writeLineTable(int fd, const Line *lines, size_t first, size_t last,
+                          const char *map, size_t mapLen)
+{
+    static char newline[] = "\n";
+    struct iovec iov[SAVE_IOV_BATCH];
+    int cnt = 0;
+
+    for (size_t i = first; i < last; ++i) {
+        char *text = lines[i].text;
+        size_t len = lines[i].len;
+        int ownNewline = map && text >= map && text + len < map + mapLen;
+        size_t span = ownNewline ? len + 1 : len;
+
+        if (span > 0) {
+            if (cnt > 0 && (char *)iov[cnt - 1].iov_base + iov[cnt - 1].iov_len == text) {
+                iov[cnt - 1].iov_len += span;
+            } else {
+                if (cnt == SAVE_IOV_BATCH) {
+                    if (writeFully(fd, iov, cnt) != 0) return -1;
+                    cnt = 0;
+                }
+                iov[cnt].iov_base = text;
+                iov[cnt++].iov_len = span;
+            }
+        }
+        if (!ownNewline) {
+            if (cnt == SAVE_IOV_BATCH) {
+                if (writeFully(fd, iov, cnt) != 0) return -1;
+                cnt = 0;
+            }
+            iov[cnt].iov_base = newline;
+            iov[cnt++].iov_len = 1;
+        }
+    }
+    return cnt > 0 ? writeFully(fd, iov, cnt) : 0;
+}
+
+/* Rewrites lines [first, last) in place starting at byte offset. When the
+ * layout shifted, last is the end of the buffer and the file is cut to size. */
+static int saveRange(Editor *ed, const char *filename, off_t offset, size_t first, size_t last)
+{
+    int fd = open(filename, O_WRONLY);
+    if (fd < 0) {
+        perror("open");
+        return -1;
+    }
+    if (lseek(fd, offset, SEEK_SET) < 0 || writeLineTable(fd, ed->lines, first, last, ed->map, ed->mapLen) != 0) {
+        perror("write");
+        close(fd);
+        return -1;
+    }
+    if (ed->layoutShifted) {
+        off_t end = lseek(fd, 0, SEEK_CUR);
+        if (end < 0 || ftruncate(fd, end) != 0) {
+            perror("ftruncate");
+            close(fd);
+            return -1;
+        }
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || close(fd) != 0) {
+        perror("close");
+        return -1;
+    }
+    if (ed->layoutShifted) indexOffsets(ed, first);
+    markClean(ed, filename, &st, 1);
+    return 0;
+}
+
+/* Writes the whole buffer to filename.tmp and renames it over filename. */
+static int saveWhole(Editor *ed, const char *filename)
+{
+    char tmpName[PATH_CAP + 8];
+    snprintf(tmpName, sizeof(tmpName), "%s.tmp", filename);
+
+    struct stat st;
+    mode_t mode = stat(filename, &st) == 0 ? (st.st_mode & 07777) : 0666;
+    int fd = open(tmpName, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (fd < 0) {
+        perror("open");
+        return -1;
+    }
+    if (writeLineTable(fd, ed->lines, 0, ed->size, ed->map, ed->mapLen) != 0) {
+        perror("write");
+        close(fd);
+        unlink(tmpName);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || close(fd) != 0) {
+        perror("close");
+        unlink(tmpName);
+        return -1;
+    }
+    if (rename(tmpName, filename) != 0) {
+        perror("rename");
+        unlink(tmpName);
+        return -1;
+    }
+    indexOffsets(ed, 0);
+    markClean(ed, filename, &st, 1);
+    return 0;
+}
+
+static int sameFileState(const struct stat *a, const struct stat *b)
+{
+    return a->st_dev == b->st_dev && a->st_ino == b->st_ino && a->st_size == b->st_size &&
+           a->st_mtim.tv_sec == b->st_mtim.tv_sec && a->st_mtim.tv_nsec == b->st_mtim.tv_nsec;
+}
+
+/* Copies text still read from the mapping at or after from into the arena. */
+static void detachText(Editor *ed, Line *line, const char *from)
+{
+    if (isMappedText(ed, line->text) && line->text + line->len >= from) {
+        line->text = arenaStrdup(&ed->arena, line->text, line->len);
+    }
+}
+
+/* Before 'lm''s own file is rewritten from offset on, moves the lines and
+ * history records that still read those bytes out of the mapping. Lines
+ * before the first dirty one all sit before offset; past the rewritten range
+ * an unshifted file keeps its bytes. */
+static void detachMapped(Editor *ed, off_t offset, size_t last)
+{
+    const char *from = ed->map + offset;
+    waitForAutosave(ed);
+    for (size_t i = ed->dirtyFrom; i < last; ++i) detachText(ed, &ed->lines[i], from);
+    UndoHistory *h = &ed->history;
+    for (size_t i = h->start; i < h->end; ++i) detachText(ed, &h->recs[i].line, from);
+}
+
+/* Saving back to the file we last loaded or saved only rewrites from the
+ * first dirty line on; if the file changed behind our back, the buffer is
+ * written out whole instead. */
+int saveToFile(Editor *ed, const char *filename)
+{
+    if (ed->pager) return pagerSave(ed, filename);
+
+    struct stat st;
+    if (ed->diskCanonical && strcmp(filename, ed->path) == 0 &&
+        stat(filename, &st) == 0 && sameFileState(&st, &ed->diskStat)) {
+        if (ed->dirtyFrom == SIZE_MAX) return 0;
+
+        off_t offset = lineOffset(ed, ed->dirtyFrom);
+        size_t last = ed->layoutShifted ? ed->size : ed->dirtyTo;
+        if (ed->map && st.st_dev == ed->mapDev && st.st_ino == ed->mapIno && (size_t)offset < ed->mapLen) {
+            detachMapped(ed, offset, last);
+        }
+        return saveRange(ed, filename, offset, ed->dirtyFrom, last);
+    }
+    return saveWhole(ed, filename);
+}
+
+
+/* --- Background autosave ---
+ * The autosave thread takes the editor lock, takes the line table as its
+ * snapshot without copying it, and writes it to <file>.autosave without the
+ * lock. While it writes, nothing it reads may change: the first edit copies
+ * the table (unshareLines), frees of line text are deferred, and in-place
+ * replacement is skipped until the snapshot is released. */
+
+static void *autosaveMain(void *arg)
+{
+    Editor *ed = arg;
+    Autosave *as = &ed->autosave;
+
+    pthread_mutex_lock(&as->lock);
+    while (!as->stop) {
+        if (as->interval == 0) {
+            pthread_cond_wait(&as->wake, &as->lock);
+            continue;
+        }
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += as->interval;
+        if (pthread_cond_timedwait(&as->wake, &as->lock, &deadline) != ETIMEDOUT) continue;
+        if (ed->changes == as->savedChanges || ed->pager) continue;
+
+        size_t count = ed->size;
+        Line *snap = ed->lines;
+        as->snapLines = snap;
+        const char *map = ed->map;
+        size_t mapLen = ed->mapLen;
+        size_t changes = ed->changes;
+        char target[PATH_CAP + 16], tmpName[PATH_CAP + 24];
+        snprintf(target, sizeof(target), "%s.autosave", ed->path[0] ? ed->path : "untitled");
+        snprintf(tmpName, sizeof(tmpName), "%s.tmp", target);
+        as->busy = 1;
+        pthread_mutex_unlock(&as->lock);
+
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        int ok = 0;
+        int fd = open(tmpName, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd >= 0) {
+            ok = writeLineTable(fd, snap, 0, count, map, mapLen) == 0 && fdatasync(fd) == 0;
+            if (close(fd) != 0) ok = 0;
+            if (ok && rename(tmpName, target) != 0) ok = 0;
+            if (!ok) unlink(tmpName);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        pthread_mutex_lock(&as->lock);
+        if (ed->lines != snap) free(snap);   /* the editor moved to its own copy */
+        as->snapLines = NULL;
+        as->busy = 0;
+        for (size_t i = 0; i < as->deferredCount; ++i) arenaFree(&ed->arena, as->deferred[i]);
+        as->deferredCount = 0;
+        as->lastOk = ok;
+        as->lastTime = time(NULL);
+        as->lastSeconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+        as->lastLines = count;
+        snprintf(as->lastTarget, sizeof(as->lastTarget), "%s", target);
+        if (ok) {
+            as->saves++;
+            as->savedChanges = changes;
+        }
+        pthread_cond_broadcast(&as->idle);
+    }
+    pthread_mutex_unlock(&as->lock);
+    return NULL;
+}
+
+/* The command loop holds the lock while it runs a command. */
+void lockEditor(Editor *ed)
+{
+    pthread_mutex_lock(&ed->autosave.lock);
+}
+
+void unlockEditor(Editor *ed)
+{
+    pthread_mutex_unlock(&ed->autosave.lock);
+}
+
+/* Called with the lock held; 0 seconds pauses autosave. */
+int setAutosaveInterval(Editor *ed, unsigned seconds)
+{
+    Autosave *as = &ed->autosave;
+    as->interval = seconds;
+    if (!as->running && seconds > 0) {
+        if (pthread_create(&as->thread, NULL, autosaveMain, ed) != 0) {
+            perror("pthread_create");
+            as->interval = 0;
+            return -1;
+        }
+        as->running = 1;
+    }
+    pthread_cond_signal(&as->wake);
+    return 0;
+}
+
+/* Called without the lock; waits for an in-flight autosave to finish. */
+void stopAutosave(Editor *ed)
+{
+    Autosave *as = &ed->autosave;
+    if (!as->running) return;
+    pthread_mutex_lock(&as->lock);
+    as->stop = 1;
+    pthread_cond_signal(&as->wake);
+    pthread_mutex_unlock(&as->lock);
+    pthread_join(as->thread, NULL);
+    as->running = 0;
+}
+
+void printStatus(const Editor *ed)
+{
+    const Autosave *as = &ed->autosave;
+    printf("File: %s, %zu lines, %s\n", ed->path[0] ? ed->path : "(none)", bufferLines(ed),
+           ed->dirtyFrom == SIZE_MAX ? "saved" : "modified");
+    if (as->interval == 0) puts("Autosave: off");
+    else printf("Autosave: every %u s%s\n", as->interval, as->busy ? " (writing now)" : "");
+    if (as->lastTime == 0) {
+        puts("Last autosave: never");
+        return;
+    }
+    char when[64];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&as->lastTime));
+    printf("Last autosave: %s, %zu lines to %s in %.3f s%s (%zu so far)\n", when, as->lastLines,
+           as->lastTarget, as->lastSeconds, as->lastOk ? "" : " FAILED", as->saves);
+}
+
+
+int loadFromFile(Editor *ed, const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        perror("fopen");
+        return -1;
+    }
+
+    waitForAutosave(ed);
+    closePager(ed);
+    arenaReleaseAll(&ed->arena);
+    unmapFile(ed);
+    resetHistory(&ed->history);
+    ed->size = 0;
+    
+    char *line = NULL;
+    size_t len = 0;
+    ssize_t nread; 
+    int endsWithNewline = 1;
+
+    while ((nread = getline(&line, &len, f)) != -1){
+        endsWithNewline = nread > 0 && line[nread - 1] == '\n';
+        if (endsWithNewline) {
+            line[nread - 1] = '\0';
+            nread--;
+        }
+        ensureCapacity(ed, ed->size + 1);
+        ed->lines[ed->size].text = arenaStrdup(&ed->arena, line, (size_t)nread);
+        ed->lines[ed->size++].len = (size_t)nread;
+    }
+
+    free(line);
+    struct stat st;
+    indexOffsets(ed, 0);
+    if (fstat(fileno(f), &st) == 0) markClean(ed, filename, &st, endsWithNewline);
+    else ed->path[0] = '\0';
+    fclose(f);
+    return 0;
+}
+
+static void appendMappedLine(Editor *ed, char *text, size_t len)
+{
+    if (ed->size == ed->capacity) ensureCapacity(ed, ed->size + 1);
+    ed->lines[ed->size].text = text;
+    ed->lines[ed->size++].len = len;
+}
+
+/* Builds the line index over buf, 16 bytes per compare where SSE2 is available. */
+static void indexLines(Editor *ed, char *buf, size_t len)
+{
+    size_t start = 0, i = 0;
+
+#if defined(__SSE2__)
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= len; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(buf + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl));
+        while (mask) {
+            size_t pos = i + (size_t)__builtin_ctz(mask);
+            appendMappedLine(ed, buf + start, pos - start);
+            start = pos + 1;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i < len) {
+        char *nlPos = memchr(buf + i, '\n', len - i);
+        if (!nlPos) break;
+        size_t pos = (size_t)(nlPos - buf);
+        appendMappedLine(ed, buf + start, pos - start);
+        start = i = pos + 1;
+    }
+    if (start < len) appendMappedLine(ed, buf + start, len - start);
+}
+
+/* Like loadFromFile, but maps the file and references every line in place;
+ * a line is only copied into the arena when it is edited. */
+int loadMappedFile(Editor *ed, const char *filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+
+    char *map = NULL;
+    size_t mapLen = (size_t)st.st_size;
+    if (mapLen > 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        map = mmap(NULL, mapLen, PROT_READ, flags, fd, 0);
+        if (map == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return -1;
+        }
+        madvise(map, mapLen, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    waitForAutosave(ed);
+    closePager(ed);
+    arenaReleaseAll(&ed->arena);
+    unmapFile(ed);
+    resetHistory(&ed->history);
+    ed->size = 0;
+    ed->map = map;
+    ed->mapLen = mapLen;
+    ed->mapDev = st.st_dev;
+    ed->mapIno = st.st_ino;
+    if (map) indexLines(ed, map, mapLen);
+    indexOffsets(ed, 0);
+    markClean(ed, filename, &st, mapLen == 0 || map[mapLen - 1] == '\n');
+    return 0;
+}
+/* Substring search: a precomputed Horspool shift table plus, where SSE2 is
+ * available, a 16-wide filter on the pattern's first and last bytes. */
 typedef struct {
-    char **lines;
-    size_t size;       
-    size_t capacity;   
-} Editor;
+    const char *text;
+    size_t len;
+    size_t skip[256];
+} Pattern;
 
-static void oom_exit(const char *msg)
+static void compilePattern(Pattern *p, const char *text, size_t len)
 {
-    if (msg) perror(msg);
-    else perror("Out of memory");
-    exit(EXIT_FAILURE);
+    p->text = text;
+    p->len = len;
+    for (size_t c = 0; c < 256; ++c) p->skip[c] = len;
+    for (size_t i = 0; i + 1 < len; ++i) p->skip[(unsigned char)text[i]] = len - 1 - i;
 }
-    
-void initEditor(Editor *ed)
+
+static const char *findPattern(const Pattern *p, const char *hay, size_t n)
 {
-    ed->size = 0;
-    ed->capacity = INITIAL_CAPACITY;
-    ed->lines = malloc(ed->capacity * sizeof(char *));
-    if (!ed->lines) oom_exit("malloc in initEditor"); 
+    size_t m = p->len, i = 0;
+    if (m == 0 || m > n) return NULL;
+    if (m == 1) return memchr(hay, p->text[0], n);
 
-    for (size_t i = 0; i < ed->capacity; ++i) ed->lines[i] = NULL;
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(p->text[0]);
+    const __m128i last = _mm_set1_epi8(p->text[m - 1]);
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(hay + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(hay + i + m - 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+        while (mask) {
+            size_t pos = i + (size_t)__builtin_ctz(mask);
+            if (memcmp(hay + pos + 1, p->text + 1, m - 2) == 0) return hay + pos;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i + m <= n) {
+        const char *c = memchr(hay + i, p->text[0], n - m + 1 - i);
+        if (!c) return NULL;
+        i = (size_t)(c - hay);
+        if (memcmp(hay + i, p->text, m) == 0) return hay + i;
+        i += p->skip[(unsigned char)hay[i + m - 1]];
+    }
+    return NULL;
 }
 
-void freeAll(Editor *ed)
+typedef struct {
+    const Editor *ed;
+    const Pattern *pat;
+    size_t first, last;    /* line range scanned by this job */
+    size_t *hits;          /* matching line indexes, ascending */
+    size_t count, cap;
+} SearchJob;
+
+static void *runSearchJob(void *arg)
 {
-    if (!ed) return;
-    for (size_t i = 0; i < ed->size; ++i) {
-        free(ed->lines[i]);
-        ed->lines[i] = NULL;
+    SearchJob *job = arg;
+    for (size_t i = job->first; i < job->last; ++i) {
+        const Line *line = &job->ed->lines[i];
+        if (!findPattern(job->pat, line->text, line->len)) continue;
+        if (job->count == job->cap) {
+            size_t newCap = job->cap ? job->cap * 2 : 64;
+            size_t *tmp = realloc(job->hits, newCap * sizeof(size_t));
+            if (!tmp) oom_exit("realloc in runSearchJob");
+            job->hits = tmp;
+            job->cap = newCap;
+        }
+        job->hits[job->count++] = i;
     }
-    free(ed->lines);
-    ed->lines = NULL;
-    ed->size = 0;
-    ed->capacity = 0;
+    return NULL;
 }
-void ensureCapacity(Editor *ed, size_t minCap)
+
+/* Returns the indexes of lines containing pat (caller frees). Large buffers
+ * are split into one line range per CPU and scanned in parallel. */
+static size_t *findMatchingLines(const Editor *ed, const Pattern *pat, size_t *count)
 {
-    if (ed->capacity >= minCap) return;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t jobs = ed->size >= SEARCH_PARALLEL_MIN_LINES && cpus > 1 ? (size_t)cpus : 1;
+    if (jobs > SEARCH_MAX_THREADS) jobs = SEARCH_MAX_THREADS;
 
-    size_t newCap = ed->capacity ? ed->capacity : 1;
-    while (newCap < minCap) newCap <<= 1;
+    SearchJob job[SEARCH_MAX_THREADS];
+    pthread_t tid[SEARCH_MAX_THREADS];
+    size_t per = (ed->size + jobs - 1) / jobs;
+    for (size_t j = 0; j < jobs; ++j) {
+        job[j] = (SearchJob){ ed, pat, j * per, (j + 1) * per, NULL, 0, 0 };
+        if (job[j].first > ed->size) job[j].first = ed->size;
+        if (job[j].last > ed->size) job[j].last = ed->size;
+    }
+    size_t started = 1;
+    for (; started < jobs; ++started) {
+        if (pthread_create(&tid[started], NULL, runSearchJob, &job[started]) != 0) break;
+    }
+    runSearchJob(&job[0]);
+    for (size_t j = started; j < jobs; ++j) runSearchJob(&job[j]);
+    for (size_t j = 1; j < started; ++j) pthread_join(tid[j], NULL);
 
-    char **tmp = realloc(ed->lines, newCap * sizeof(char *));
-    if (!tmp) oom_exit("realloc");
-    ed->lines = tmp;
+    size_t total = 0;
+    for (size_t j = 0; j < jobs; ++j) total += job[j].count;
+    size_t *hits = job[0].hits;
+    if (jobs > 1) {
+        hits = malloc((total ? total : 1) * sizeof(size_t));
+        if (!hits) oom_exit("malloc in findMatchingLines");
+        size_t at = 0;
+        for (size_t j = 0; j < jobs; ++j) {
+            if (job[j].count) memcpy(&hits[at], job[j].hits, job[j].count * sizeof(size_t));
+            at += job[j].count;
+            free(job[j].hits);
+        }
+    }
+    *count = total;
+    return hits;
+}
 
-    for (size_t i = ed->capacity; i < newCap; ++i) ed->lines[i] = NULL;
-    ed->capacity = newCap;
+static size_t pagerSearch(Editor *ed, const Pattern *pat, LineSink sink, void *ctx);
+
+size_t searchBuffer(Editor *ed, const char *pattern, LineSink sink, void *ctx)
+{
+    Pattern pat;
+    compilePattern(&pat, pattern, strlen(pattern));
+    if (ed->pager) return pagerSearch(ed, &pat, sink, ctx);
+    size_t count;
+    size_t *hits = findMatchingLines(ed, &pat, &count);
+    for (size_t k = 0; sink && k < count; ++k) {
+        const Line *line = &ed->lines[hits[k]];
+        sink(ctx, hits[k] + 1, line->text, line->len);
+    }
+    free(hits);
+    return count;
 }
 
+void searchLines(Editor *ed, const char *pattern)
+{
+    size_t count = searchBuffer(ed, pattern, printLine, NULL);
+    printf("%zu matching line%s\n", count, count == 1 ? "" : "s");
+}
 
-void insertLine(Editor *ed, size_t index, const char *text)
+/* Replaces every occurrence of from with to; returns the number replaced.
+ * A line's own block is rewritten in place when the new text fits and no
+ * undo record needs the old text; otherwise the new text gets a fresh block. */
+size_t replaceAll(Editor *ed, const char *from, const char *to, size_t *linesChanged)
 {
-    if (index > ed->size) {
-        fprintf(stderr, "insertLine: invalid index %zu (size %zu)\n", index, ed->size);
-        return;
+    Pattern pat;
+    compilePattern(&pat, from, strlen(from));
+    size_t toLen = strlen(to);
+    size_t count, replaced = 0;
+    size_t *hits = findMatchingLines(ed, &pat, &count);
+
+    char *scratch = NULL;
+    size_t scratchCap = 0;
+    historyBeginGroup(ed);
+    for (size_t k = 0; k < count; ++k) {
+        size_t idx = hits[k];
+        Line old = ed->lines[idx];
+
+        size_t outLen = 0, pos = 0;
+        const char *m;
+        while ((m = findPattern(&pat, old.text + pos, old.len - pos)) != NULL) {
+            size_t keep = (size_t)(m - (old.text + pos));
+            if (outLen + keep + toLen + 1 > scratchCap) {
+                size_t newCap = scratchCap ? scratchCap : 256;
+                while (newCap < outLen + keep + toLen + 1) newCap <<= 1;
+                char *tmp = realloc(scratch, newCap);
+                if (!tmp) oom_exit("realloc in replaceAll");
+                scratch = tmp;
+                scratchCap = newCap;
+            }
+            memcpy(scratch + outLen, old.text + pos, keep);
+            memcpy(scratch + outLen + keep, to, toLen);
+            outLen += keep + toLen;
+            pos += keep + pat.len;
+            replaced++;
+        }
+        size_t tail = old.len - pos;
+        if (outLen + tail + 1 > scratchCap) {
+            char *tmp = realloc(scratch, outLen + tail + 1);
+            if (!tmp) oom_exit("realloc in replaceAll");
+            scratch = tmp;
+            scratchCap = outLen + tail + 1;
+        }
+        memcpy(scratch + outLen, old.text + pos, tail);
+        outLen += tail;
+
+        if (ed->history.depth == 0 && !ed->autosave.busy && !isMappedText(ed, old.text) &&
+            outLen + 1 <= arenaCapacity(old.text)) {
+            memcpy(old.text, scratch, outLen);
+            old.text[outLen] = '\0';
+            ed->lines[idx].len = outLen;
+            markDirty(ed, idx, idx + 1, outLen != old.len);
+        } else {
+            Line line = { arenaStrdup(&ed->arena, scratch, outLen), outLen };
+            Line prev = line;
+            swapLine(ed, idx, &prev);
+            recordEdit(ed, UNDO_REPLACE, idx, prev);
+        }
     }
-    ensureCapacity(ed, ed->size + 1);
+    historyEndGroup(ed);
+    free(scratch);
+    free(hits);
+    *linesChanged = count;
+    return replaced;
+}
 
-    if (index < ed->size) {
-        memmove(&ed->lines[index + 1], &ed->lines[index],
-                (ed->size - index) * sizeof(char *));
+/* --- Paged mode ---
+ * 'lp' keeps only a sparse index of the file: one window per PAGE_LINES
+ * lines, holding the window's byte offset, length and line count. A window's
+ * lines are read on first use and the least recently used clean windows are
+ * dropped once the resident ones exceed the budget. Edited windows stay
+ * resident until the next save, which streams untouched windows straight
+ * from the old file. */
+
+static int inWindowBuf(const Window *w, const char *text)
+{
+    return text >= w->buf && text < w->buf + w->bufLen;
+}
+
+static void pagerEvict(Editor *ed, Window *w)
+{
+    Pager *p = ed->pager;
+    for (size_t i = 0; i < w->count; ++i) {
+        char *text = w->lines[i].text;
+        if (!inWindowBuf(w, text)) arenaFree(&ed->arena, text);
     }
-    size_t len = strlen(text);
-    char *copy = malloc(len + 1);
-    if (!copy) oom_exit("malloc");
-    memcpy(copy, text, len + 1);
+    free(w->buf);
+    free(w->lines);
+    w->buf = NULL;
+    w->lines = NULL;
+    w->cap = 0;
+    w->bufLen = 0;
+    p->resident -= w->mem;
+    w->mem = 0;
+    p->evictions++;
+}
 
-    ed->lines[index] = copy;
-    ed->size++;
+static void pagerEvictOverBudget(Editor *ed, const Window *keep)
+{
+    Pager *p = ed->pager;
+    while (p->resident > p->budget) {
+        Window *victim = NULL;
+        for (size_t i = 0; i < p->winCount; ++i) {
+            Window *w = &p->wins[i];
+            if (!w->lines || w->dirty || w == keep) continue;
+            if (!victim || w->lastUse < victim->lastUse) victim = w;
+        }
+        if (!victim) return;
+        pagerEvict(ed, victim);
+    }
 }
 
-void deleteLine(Editor *ed, size_t index)
+static void splitWindow(Window *w)
 {
-    if (index >= ed->size) {
-        fprintf(stderr, "deleteLine: invalid index %zu (size %zu)\n", index, ed->size);
-        return;
+    size_t start = 0, n = 0;
+    while (n < w->count) {
+        const char *nl = memchr(w->buf + start, '\n', w->bytes - start);
+        size_t end = nl ? (size_t)(nl - w->buf) : w->bytes;
+        w->lines[n].text = w->buf + start;
+        w->lines[n++].len = end - start;
+        start = end + 1;
     }
-    free(ed->lines[index]);
-    if (index + 1 < ed->size) {
-        memmove(&ed->lines[index], &ed->lines[index + 1],
-                (ed->size - index - 1) * sizeof(char *));
+}
+
+/* Makes the window resident; returns -1 if it could not be read. */
+static int pagerLoad(Editor *ed, Window *w)
+{
+    Pager *p = ed->pager;
+    w->lastUse = ++p->clock;
+    if (w->lines) return 0;
+
+    w->cap = w->count ? w->count : 16;
+    w->buf = malloc(w->bytes ? w->bytes : 1);
+    w->lines = malloc(w->cap * sizeof(Line));
+    if (!w->buf || !w->lines) oom_exit("malloc in pagerLoad");
+    size_t done = 0;
+    while (done < w->bytes) {
+        ssize_t n = pread(p->fd, w->buf + done, w->bytes - done, w->offset + (off_t)done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            perror("pread");
+            free(w->buf);
+            free(w->lines);
+            w->buf = NULL;
+            w->lines = NULL;
+            return -1;
+        }
+        done += (size_t)n;
     }
-    ed->size--;
-    ed->lines[ed->size] = NULL; 
+    w->bufLen = w->bytes;
+    splitWindow(w);
+    w->mem = w->bytes + w->cap * sizeof(Line);
+    p->resident += w->mem;
+    p->loads++;
+    pagerEvictOverBudget(ed, w);
+    return 0;
 }
 
-void printAllLines(const Editor *ed)
+/* Finds the window holding line index; index == totalLines maps to the end
+ * of the last window so that appends land there. */
+static Window *pagerLocate(Pager *p, size_t index, size_t *within)
 {
-    printf("--- Buffer Contents (%zu lines, capacity %zu) ---\n", ed->size, ed->capacity);
-    for (size_t i = 0; i < ed->size; ++i) {
-        printf("%zu: %s\n", i + 1, ed->lines[i]);
+    for (size_t i = 0; i < p->winCount; ++i) {
+        Window *w = &p->wins[i];
+        if (index < w->count || (index == w->count && i + 1 == p->winCount)) {
+            *within = index;
+            return w;
+        }
+        index -= w->count;
     }
-    printf("-----------------------------------\n");
+    return NULL;
 }
-void shrinkToFit(Editor *ed)
+
+static void pagerInsert(Editor *ed, size_t index, Line line)
 {
-    if (ed->size == ed->capacity) return;
-    
-    if (ed->size == 0) {
-        char **tmp = realloc(ed->lines, INITIAL_CAPACITY * sizeof(char *));
-        if (!tmp) oom_exit("realloc (shrink to fit zero)");
-        ed->lines = tmp;
-        for (size_t i = 0; i < INITIAL_CAPACITY; ++i) ed->lines[i] = NULL;
-        ed->capacity = INITIAL_CAPACITY;
+    Pager *p = ed->pager;
+    size_t within;
+    Window *w = pagerLocate(p, index, &within);
+    if (!w) {
+        p->wins = calloc(1, sizeof(Window));
+        if (!p->wins) oom_exit("calloc in pagerInsert");
+        p->winCount = 1;
+        w = p->wins;
+        within = 0;
+    }
+    if (pagerLoad(ed, w) != 0) {
+        arenaFree(&ed->arena, line.text);
         return;
     }
+    if (w->count == w->cap) {
+        Line *tmp = realloc(w->lines, w->cap * 2 * sizeof(Line));
+        if (!tmp) oom_exit("realloc in pagerInsert");
+        w->lines = tmp;
+        p->resident += w->cap * sizeof(Line);
+        w->mem += w->cap * sizeof(Line);
+        w->cap *= 2;
+    }
+    memmove(&w->lines[within + 1], &w->lines[within], (w->count - within) * sizeof(Line));
+    w->lines[within] = line;
+    w->count++;
+    w->dirty = 1;
+    p->totalLines++;
+    ed->dirtyFrom = 0;
+    ed->changes++;
+}
 
-    char **tmp = realloc(ed->lines, ed->size * sizeof(char *));
-    if (!tmp) oom_exit("realloc");
-    ed->lines = tmp;
-    ed->capacity = ed->size;
+static void pagerDelete(Editor *ed, size_t index)
+{
+    Pager *p = ed->pager;
+    size_t within;
+    Window *w = pagerLocate(p, index, &within);
+    if (!w || within >= w->count || pagerLoad(ed, w) != 0) return;
+    char *text = w->lines[within].text;
+    if (!inWindowBuf(w, text)) arenaFree(&ed->arena, text);
+    memmove(&w->lines[within], &w->lines[within + 1], (w->count - within - 1) * sizeof(Line));
+    w->count--;
+    w->dirty = 1;
+    p->totalLines--;
+    ed->dirtyFrom = 0;
+    ed->changes++;
 }
 
+void closePager(Editor *ed)
+{
+    Pager *p = ed->pager;
+    if (!p) return;
+    for (size_t i = 0; i < p->winCount; ++i) {
+        free(p->wins[i].buf);
+        free(p->wins[i].lines);
+    }
+    free(p->wins);
+    close(p->fd);
+    free(p);
+    ed->pager = NULL;
+    arenaReleaseAll(&ed->arena);
+}
 
-int saveToFile(const Editor *ed, const char *filename)
+/* Opens filename in paged mode, replacing the current buffer. */
+int openPagedFile(Editor *ed, const char *filename, size_t budget)
 {
-    FILE *f = fopen(filename, "w");
-    if (!f) {
-        perror("fopen");
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("open");
         return -1;
     }
-    for (size_t i = 0; i < ed->size; ++i) {
-        if (fprintf(f, "%s\n", ed->lines[i]) < 0) {
-            perror("fprintf");
-            fclose(f);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        perror("fstat");
+        close(fd);
+        return -1;
+    }
+    Pager *p = calloc(1, sizeof(Pager));
+    char *chunk = malloc(PAGER_SCAN_CHUNK);
+    if (!p || !chunk) oom_exit("malloc in openPagedFile");
+    p->fd = fd;
+    p->budget = budget;
+
+    /* One pass over the file to find where every PAGE_LINES-th line starts. */
+    off_t pos = 0, winStart = 0;
+    size_t inWindow = 0, winCap = 0;
+    char lastByte = '\n';
+    for (;;) {
+        ssize_t n = pread(fd, chunk, PAGER_SCAN_CHUNK, pos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            perror("pread");
+            free(chunk);
+            free(p->wins);
+            free(p);
+            close(fd);
             return -1;
         }
+        if (n == 0) break;
+        const char *c = chunk, *end = chunk + n;
+        while ((c = memchr(c, '\n', (size_t)(end - c))) != NULL) {
+            c++;
+            if (++inWindow == PAGE_LINES) {
+                if (p->winCount == winCap) {
+                    winCap = winCap ? winCap * 2 : 64;
+                    Window *tmp = realloc(p->wins, winCap * sizeof(Window));
+                    if (!tmp) oom_exit("realloc in openPagedFile");
+                    p->wins = tmp;
+                }
+                off_t next = pos + (c - chunk);
+                p->wins[p->winCount++] = (Window){ .offset = winStart,
+                                                   .bytes = (size_t)(next - winStart),
+                                                   .count = PAGE_LINES };
+                p->totalLines += PAGE_LINES;
+                winStart = next;
+                inWindow = 0;
+            }
+        }
+        lastByte = chunk[n - 1];
+        pos += n;
     }
-    fclose(f);
+    free(chunk);
+    if (pos > winStart) {
+        if (lastByte != '\n') inWindow++;
+        Window *tmp = realloc(p->wins, (p->winCount + 1) * sizeof(Window));
+        if (!tmp) oom_exit("realloc in openPagedFile");
+        p->wins = tmp;
+        p->wins[p->winCount++] = (Window){ .offset = winStart,
+                                           .bytes = (size_t)(pos - winStart),
+                                           .count = inWindow };
+        p->totalLines += inWindow;
+    }
+    p->endsWithNewline = lastByte == '\n';
+
+    waitForAutosave(ed);
+    closePager(ed);
+    arenaReleaseAll(&ed->arena);
+    unmapFile(ed);
+    resetHistory(&ed->history);
+    ed->size = 0;
+    ed->pager = p;
+    markClean(ed, filename, &st, p->endsWithNewline);
     return 0;
 }
 
-
-int loadFromFile(Editor *ed, const char *filename)
+/* Streams the paged buffer to filename via a temp file, then follows the
+ * new file: every window becomes clean and evictable again. */
+static int pagerSave(Editor *ed, const char *filename)
 {
-    FILE *f = fopen(filename, "r");
-    if (!f) {
-        perror("fopen");
+    Pager *p = ed->pager;
+    char tmpName[PATH_CAP + 8];
+    snprintf(tmpName, sizeof(tmpName), "%s.tmp", filename);
+    struct stat st;
+    mode_t mode = stat(filename, &st) == 0 ? (st.st_mode & 07777) : 0666;
+    int fd = open(tmpName, O_RDWR | O_CREAT | O_TRUNC, mode);
+    if (fd < 0) {
+        perror("open");
         return -1;
     }
+    char *chunk = malloc(PAGER_SCAN_CHUNK);
+    off_t *newOffset = malloc((p->winCount + 1) * sizeof(off_t));
+    if (!chunk || !newOffset) oom_exit("malloc in pagerSave");
 
-    for (size_t i = 0; i < ed->size; ++i) free(ed->lines[i]);
-    ed->size = 0;
-    
+    off_t out = 0;
+    int rc = 0;
+    for (size_t i = 0; i < p->winCount && rc == 0; ++i) {
+        Window *w = &p->wins[i];
+        newOffset[i] = out;
+        if (w->lines) {
+            rc = writeLineTable(fd, w->lines, 0, w->count, w->buf, w->bufLen);
+            for (size_t k = 0; k < w->count; ++k) out += (off_t)w->lines[k].len + 1;
+            continue;
+        }
+        for (size_t done = 0; done < w->bytes && rc == 0; ) {
+            size_t want = w->bytes - done < PAGER_SCAN_CHUNK ? w->bytes - done : PAGER_SCAN_CHUNK;
+            ssize_t n = pread(p->fd, chunk, want, w->offset + (off_t)done);
+            if (n < 0 && errno == EINTR) continue;
+            struct iovec iov = { chunk, (size_t)(n > 0 ? n : 0) };
+            if (n <= 0 || writeFully(fd, &iov, 1) != 0) rc = -1;
+            done += n > 0 ? (size_t)n : 0;
+        }
+        out += (off_t)w->bytes;
+        if (rc == 0 && i + 1 == p->winCount && !p->endsWithNewline && w->bytes > 0) {
+            struct iovec iov = { "\n", 1 };
+            rc = writeFully(fd, &iov, 1);
+            out++;
+        }
+    }
+    newOffset[p->winCount] = out;
+    free(chunk);
+
+    if (rc != 0 || fstat(fd, &st) != 0 || rename(tmpName, filename) != 0) {
+        perror("save");
+        close(fd);
+        unlink(tmpName);
+        free(newOffset);
+        return -1;
+    }
+    close(p->fd);
+    p->fd = fd;
+    p->endsWithNewline = 1;
+    for (size_t i = 0; i < p->winCount; ++i) {
+        p->wins[i].offset = newOffset[i];
+        p->wins[i].bytes = (size_t)(newOffset[i + 1] - newOffset[i]);
+        p->wins[i].dirty = 0;
+    }
+    free(newOffset);
+    markClean(ed, filename, &st, 1);
+    pagerEvictOverBudget(ed, NULL);
+    return 0;
+}
+
+void printLineRange(Editor *ed, size_t first, size_t last)
+{
+    if (first < 1) return;
+    visitLines(ed, first, last, printLine, NULL);
+}
+
+static size_t pagerSearch(Editor *ed, const Pattern *pat, LineSink sink, void *ctx)
+{
+    Pager *p = ed->pager;
+    size_t base = 0, count = 0;
+    for (size_t i = 0; i < p->winCount; ++i) {
+        Window *w = &p->wins[i];
+        if (pagerLoad(ed, w) != 0) break;
+        for (size_t k = 0; k < w->count; ++k) {
+            const Line *line = &w->lines[k];
+            if (!findPattern(pat, line->text, line->len)) continue;
+            if (sink) sink(ctx, base + k + 1, line->text, line->len);
+            count++;
+        }
+        base += w->count;
+    }
+    return count;
+}
+
+void setPagerBudget(Editor *ed, size_t bytes)
+{
+    ed->pagerBudget = bytes;
+    if (ed->pager) {
+        ed->pager->budget = bytes;
+        pagerEvictOverBudget(ed, NULL);
+    }
+}
+
+void printPagerStats(const Editor *ed)
+{
+    const Pager *p = ed->pager;
+    size_t resident = 0, dirty = 0;
+    for (size_t i = 0; i < p->winCount; ++i) {
+        if (p->wins[i].lines) resident++;
+        if (p->wins[i].dirty) dirty++;
+    }
+    printf("Paged: %zu windows of %d lines, %zu resident (%zu dirty), %zu of %zu KB budget used\n",
+           p->winCount, PAGE_LINES, resident, dirty, p->resident / 1024, p->budget / 1024);
+    printf("Window loads: %zu, evictions: %zu\n", p->loads, p->evictions);
+}
+
+/* Undo, replace, autosave and table shrinking only work on a loaded buffer. */
+static int pagedCommand(const char *cmd)
+{
+    static const char *const refused[] = { "u", "y", "hd", "x", "as", "r" };
+    for (size_t i = 0; i < sizeof(refused) / sizeof(refused[0]); ++i) {
+        if (strcmp(cmd, refused[i]) == 0) return 0;
+    }
+    return 1;
+}
+
+/* Splits the arguments of 'x': old is the first word and new is the rest of
+ * the line after one space or tab, so it may hold spaces or be empty. */
+static int splitReplace(char *rest, char **from, char **to)
+{
+    char *p = rest;
+    while (*p && *p != ' ' && *p != '\t') p++;
+    if (p == rest) return -1;
+    *from = rest;
+    *to = *p ? p + 1 : p;
+    *p = '\0';
+    return 0;
+}
+
+/* Reads an unsigned line number; strtoull alone would take a sign or leading blanks. */
+static int parseLineNumber(const char *text, char **end, unsigned long long *out)
+{
+    if (*text < '0' || *text > '9') return -1;
+    errno = 0;
+    *out = strtoull(text, end, 10);
+    return errno ? -1 : 0;
+}
+
+/* p, p <line> or p <from> <to>; returns -1 on a bad range. */
+static int printCommand(Editor *ed, const char *rest)
+{
+    if (*rest == '\0') {
+        printAllLines(ed);
+        return 0;
+    }
+    char *end;
+    unsigned long long first, last;
+    if (parseLineNumber(rest, &end, &first) != 0 || first < 1) return -1;
+    last = first;
+    while (*end == ' ') end++;
+    if (*end) {
+        if (parseLineNumber(end, &end, &last) != 0 || *end || last < first) return -1;
+    }
+    printLineRange(ed, (size_t)first, (size_t)last);
+    return 0;
+}
+
+/* Batch mode: one command per line, no prompts and no status output.
+ *   a <index> <text>    insert text (the rest of the line) before line index
+ *   d <index> [count]   delete count lines (default 1) starting at index
+ *   s|l|lm|lp <filename>, f <pattern>, x <old> <new>, p [from [to]], u, y, r,
+ *   hd <depth>, pb <MB>, q
+ * Blank lines and lines starting with '#' are skipped. A run of inserts at
+ * consecutive positions, or of deletes at one position, is applied as one
+ * bulk edit. History is off unless the script turns it on with hd. */
+typedef struct {
+    size_t index;          /* 0-based position of the pending run */
+    Line *lines;           /* pending inserts */
+    size_t count, cap;
+    size_t deletes;        /* pending deletes at index */
+} BatchRun;
+
+static void flushRun(Editor *ed, BatchRun *run)
+{
+    if (run->count) insertLines(ed, run->index, run->lines, run->count);
+    if (run->deletes) deleteLines(ed, run->index, run->deletes);
+    run->count = 0;
+    run->deletes = 0;
+}
+
+static int parseIndex(const char *s, char **end, size_t *out)
+{
+    errno = 0;
+    unsigned long long v = strtoull(s, end, 10);
+    if (*end == s || errno || v < 1) return -1;
+    *out = (size_t)v - 1;
+    return 0;
+}
+
+static int batchInsert(Editor *ed, BatchRun *run, char *rest)
+{
+    char *end;
+    size_t index;
+    if (parseIndex(rest, &end, &index) != 0 || (*end && *end != ' ')) return -1;
+    const char *text = *end ? end + 1 : end;
+
+    if (run->deletes || !run->count || index != run->index + run->count) {
+        flushRun(ed, run);
+        if (index > bufferLines(ed)) return -1;
+        run->index = index;
+    }
+    if (run->count == run->cap) {
+        size_t newCap = run->cap ? run->cap * 2 : 256;
+        Line *tmp = realloc(run->lines, newCap * sizeof(Line));
+        if (!tmp) oom_exit("realloc in batchInsert");
+        run->lines = tmp;
+        run->cap = newCap;
+    }
+    size_t len = strlen(text);
+    run->lines[run->count].text = arenaStrdup(&ed->arena, text, len);
+    run->lines[run->count++].len = len;
+    return 0;
+}
+
+static int batchDelete(Editor *ed, BatchRun *run, char *rest)
+{
+    char *end;
+    size_t index, count = 1;
+    if (parseIndex(rest, &end, &index) != 0) return -1;
+    while (*end == ' ') end++;
+    if (*end) {
+        char *countEnd;
+        errno = 0;
+        unsigned long long v = strtoull(end, &countEnd, 10);
+        if (countEnd == end || *countEnd || errno || v < 1) return -1;
+        count = (size_t)v;
+    }
+
+    if (run->count || !run->deletes || index != run->index) {
+        flushRun(ed, run);
+        run->index = index;
+    }
+    if (index > bufferLines(ed) || run->deletes + count > bufferLines(ed) - index) return -1;
+    run->deletes += count;
+    return 0;
+}
+
+/* Returns 0 when the whole script ran, -1 at the first bad line. */
+int runBatch(Editor *ed, FILE *in, const char *scriptName)
+{
+    BatchRun run = { 0, NULL, 0, 0, 0 };
     char *line = NULL;
-    size_t len = 0;
-    ssize_t nread; 
+    size_t cap = 0;
+    ssize_t nread;
+    size_t lineNo = 0;
+    int rc = 0;
 
-    while ((nread = getline(&line, &len, f)) != -1){
-        if (nread > 0 && line[nread - 1] == '\n') {
-            line[nread - 1] = '\0';
-            nread--;
+    setHistoryDepth(ed, 0);
+    setvbuf(in, NULL, _IOFBF, 1 << 20);
+    while ((nread = getline(&line, &cap, in)) != -1) {
+        lineNo++;
+        if (nread > 0 && line[nread - 1] == '\n') line[--nread] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        char *rest = line;
+        while (*rest && *rest != ' ') rest++;
+        if (*rest) *rest++ = '\0';
+        const char *cmd = line;
+
+        int bad = 0;
+        if (strcmp(cmd, "a") == 0) {
+            bad = batchInsert(ed, &run, rest);
+        } else if (strcmp(cmd, "d") == 0) {
+            bad = batchDelete(ed, &run, rest);
+        } else if (ed->pager && !pagedCommand(cmd)) {
+            bad = -1;
+        } else {
+            flushRun(ed, &run);
+            if (strcmp(cmd, "s") == 0) bad = *rest ? saveToFile(ed, rest) : -1;
+            else if (strcmp(cmd, "l") == 0) bad = *rest ? loadFromFile(ed, rest) : -1;
+            else if (strcmp(cmd, "lm") == 0) bad = *rest ? loadMappedFile(ed, rest) : -1;
+            else if (strcmp(cmd, "lp") == 0) bad = *rest ? openPagedFile(ed, rest, ed->pagerBudget) : -1;
+            else if (strcmp(cmd, "f") == 0) {
+                if (*rest) searchLines(ed, rest);
+                else bad = -1;
+            }
+            else if (strcmp(cmd, "x") == 0) {
+                char *from, *to;
+                size_t lines;
+                if (splitReplace(rest, &from, &to) == 0) replaceAll(ed, from, to, &lines);
+                else bad = -1;
+            }
+            else if (strcmp(cmd, "p") == 0) bad = printCommand(ed, rest);
+            else if (strcmp(cmd, "u") == 0) undoEdit(ed);
+            else if (strcmp(cmd, "y") == 0) redoEdit(ed);
+            else if (strcmp(cmd, "r") == 0) shrinkToFit(ed);
+            else if (strcmp(cmd, "hd") == 0) {
+                char *end;
+                errno = 0;
+                unsigned long long depth = strtoull(rest, &end, 10);
+                if (end == rest || *end || errno) bad = -1;
+                else setHistoryDepth(ed, (size_t)depth);
+            }
+            else if (strcmp(cmd, "pb") == 0) {
+                char *end;
+                unsigned long long mb = strtoull(rest, &end, 10);
+                if (end == rest || *end || mb == 0) bad = -1;
+                else setPagerBudget(ed, (size_t)mb * 1024 * 1024);
+            }
+            else if (strcmp(cmd, "q") == 0) break;
+            else bad = -1;
         }
-        ensureCapacity(ed, ed->size + 1);
-        
-        char *copy = malloc((size_t)nread + 1); 
-        if (!copy) {
-            free(line);
-            fclose(f);
-            oom_exit("malloc");
+        if (bad) {
+            fprintf(stderr, "%s:%zu: cannot apply '%s'\n", scriptName, lineNo, cmd);
+            rc = -1;
+            break;
         }
-        memcpy(copy, line, (size_t)nread + 1);
-        ed->lines[ed->size++] = copy;
     }
-
+    if (rc == 0) flushRun(ed, &run);
+    for (size_t k = 0; rc != 0 && k < run.count; ++k) arenaFree(&ed->arena, run.lines[k].text);
+    free(run.lines);
     free(line);
-    fclose(f);
-    return 0;
+    return rc;
 }
+
+#ifndef PF_LIBRARY
 void printHelp(void)
 {
     puts("Commands:");
     puts("  a <index>     - insert (append if index == size+1). After pressing Enter the program will prompt for the text line.");
     puts("  d <index>     - delete line at index (1-based)");
-    puts("  p             - print all lines (shows capacity)");
+    puts("  p [from [to]] - print all lines (shows capacity), or just lines from..to");
     puts("  s <filename>  - save to file");
     puts("  l <filename>  - load from file (replaces buffer)");
+    puts("  lm <filename> - load by mapping the file (lines are copied only when edited)");
+    puts("  lp <filename> - open in paged mode: windows of lines are read on demand (for huge files)");
+    puts("  pb <MB>       - memory budget for paged mode windows");
     puts("  r             - shrinkToFit (release unused memory)");
+    puts("  m             - show line allocator statistics");
+    puts("  u             - undo the last edit");
+    puts("  y             - redo the last undone edit");
+    puts("  hd <depth>    - set how many edits undo remembers (0 turns history off)");
+    puts("  f <pattern>   - list lines containing pattern");
+    puts("  x <old> [new] - replace every occurrence of old with new (the rest of the line, spaces included;");
+    puts("                  leave it out to delete old)");
+    puts("  as <seconds>  - autosave to <file>.autosave in the background (0 turns it off)");
+    puts("  st            - show file, modification and last autosave status");
     puts("  q             - quit (frees memory)");
     puts("  h             - help");
+    puts("Run with -b <script> (or -b - for stdin) to apply a command script without prompts.");
 }
 
 char *readInputLine(const char *prompt)
@@ -206,30 +1917,78 @@ char *readInputLine(const char *prompt)
     return buf;
 }
 
-int main(void)
+/* A command's whole argument as a decimal number. */
+static int parseNumber(const char *rest, long *out)
+{
+    char *end;
+    errno = 0;
+    long v = strtol(rest, &end, 10);
+    if (end == rest || *end || errno) return -1;
+    *out = v;
+    return 0;
+}
+
+int main(int argc, char **argv)
 {
     Editor ed;
     initEditor(&ed);
 
+    if (argc == 3 && strcmp(argv[1], "-b") == 0) {
+        FILE *in = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+        if (!in) {
+            perror("fopen");
+            freeAll(&ed);
+            return EXIT_FAILURE;
+        }
+        int rc = runBatch(&ed, in, argv[2]);
+        if (in != stdin) fclose(in);
+        freeAll(&ed);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (argc != 1) {
+        fprintf(stderr, "Usage: %s [-b <script>|-]\n", argv[0]);
+        freeAll(&ed);
+        return EXIT_FAILURE;
+    }
+
     printf("Lightweight command-line line editor\n");
     printHelp();
 
     char cmd[8];
+    char *args = NULL;
+    size_t argsCap = 0;
+    char noArgs[1] = "";
+    lockEditor(&ed);
     while (1) {
+        unlockEditor(&ed);
         printf("\n> ");
-        if (scanf("%7s", cmd) != 1) break;
+        if (scanf("%7s", cmd) != 1) {
+            lockEditor(&ed);
+            break;
+        }
 
-        int c; while ((c = getchar()) != '\n' && c != EOF);
+        /* Whatever follows the command on the same line. */
+        ssize_t argLen = getline(&args, &argsCap, stdin);
+        char *rest = argLen > 0 ? args : noArgs;
+        if (argLen > 0 && rest[argLen - 1] == '\n') rest[argLen - 1] = '\0';
+        while (*rest == ' ' || *rest == '\t') rest++;
+        lockEditor(&ed);
+
+        if (ed.pager && !pagedCommand(cmd)) {
+            printf("'%s' is not available in paged mode.\n", cmd);
+            continue;
+        }
 
         if (strcmp(cmd, "a") == 0) {
             long idx;
-            if (scanf("%ld", &idx) != 1) {
+            if (parseNumber(rest, &idx) != 0) {
                 fprintf(stderr, "Invalid index\n");
-                int c; while ((c = getchar()) != '\n' && c != EOF); 
                 continue;
             }
-            int c; while ((c = getchar()) != '\n' && c != EOF); 
+            /* Don't hold autosave off while waiting for the user. */
+            unlockEditor(&ed);
             char *text = readInputLine("Enter text: ");
+            lockEditor(&ed);
             if (!text) {
                 puts("No input provided.");
                 continue;
@@ -240,8 +1999,8 @@ int main(void)
                 continue;
             }
             size_t insertPos = (size_t)(idx - 1);
-            if (insertPos > ed.size) {
-                fprintf(stderr, "Index too large (current size %zu). Use %zu to append.\n", ed.size, ed.size + 1);
+            if (insertPos > bufferLines(&ed)) {
+                fprintf(stderr, "Index too large (current size %zu). Use %zu to append.\n", bufferLines(&ed), bufferLines(&ed) + 1);
                 free(text);
                 continue;
             }
@@ -249,47 +2008,129 @@ int main(void)
             insertLine(&ed, insertPos, text);
             free(text);
 
-            printf("Inserted at %zu. Size now: %zu\n", insertPos + 1, ed.size);
+            printf("Inserted at %zu. Size now: %zu\n", insertPos + 1, bufferLines(&ed));
         }
         else if (strcmp(cmd, "d") == 0) {
             long idx;
-            if (scanf("%ld", &idx) != 1) {
+            if (parseNumber(rest, &idx) != 0) {
                 fprintf(stderr, "Invalid index\n");
-                int c; while ((c = getchar()) != '\n' && c != EOF);
                 continue;
             }
-            if (idx < 1 || (size_t)idx > ed.size) {
-                fprintf(stderr, "Invalid index (1..%zu)\n", ed.size);
+            if (idx < 1 || (size_t)idx > bufferLines(&ed)) {
+                fprintf(stderr, "Invalid index (1..%zu)\n", bufferLines(&ed));
                 continue;
             }
             deleteLine(&ed, (size_t)idx - 1);
-            printf("Deleted. Size now: %zu\n", ed.size);
+            printf("Deleted. Size now: %zu\n", bufferLines(&ed));
         }
         else if (strcmp(cmd, "p") == 0) {
-            printAllLines(&ed);
+            if (printCommand(&ed, rest) != 0) fprintf(stderr, "Usage: p [from [to]]\n");
         }
         else if (strcmp(cmd, "s") == 0) {
-            char filename[256];
-            if (scanf("%255s", filename) != 1) {
-                fprintf(stderr, "Invalid filename\n");
+            const char *filename = rest;
+            if (*filename == '\0') {
+                fprintf(stderr, "Usage: s <filename>\n");
                 continue;
             }
             if (saveToFile(&ed, filename) == 0) printf("Saved to %s\n", filename);
         }
         else if (strcmp(cmd, "l") == 0) {
-            char filename[256];
-            if (scanf("%255s", filename) != 1) {
-                fprintf(stderr, "Invalid filename\n");
+            const char *filename = rest;
+            if (*filename == '\0') {
+                fprintf(stderr, "Usage: l <filename>\n");
                 continue;
             }
             if (loadFromFile(&ed, filename) == 0) {
                 printf("Loaded %zu lines from %s\n", ed.size, filename);
             }
         }
+        else if (strcmp(cmd, "lm") == 0) {
+            const char *filename = rest;
+            if (*filename == '\0') {
+                fprintf(stderr, "Usage: lm <filename>\n");
+                continue;
+            }
+            if (loadMappedFile(&ed, filename) == 0) {
+                printf("Mapped %zu lines from %s\n", ed.size, filename);
+            }
+        }
+        else if (strcmp(cmd, "lp") == 0) {
+            if (*rest == '\0') {
+                fprintf(stderr, "Usage: lp <filename>\n");
+                continue;
+            }
+            if (openPagedFile(&ed, rest, ed.pagerBudget) == 0) {
+                printf("Opened %s in paged mode: %zu lines in %zu windows\n", rest,
+                       ed.pager->totalLines, ed.pager->winCount);
+            }
+        }
+        else if (strcmp(cmd, "pb") == 0) {
+            char *end;
+            unsigned long mb = strtoul(rest, &end, 10);
+            if (end == rest || *end || mb == 0) {
+                fprintf(stderr, "Usage: pb <MB>\n");
+                continue;
+            }
+            setPagerBudget(&ed, (size_t)mb * 1024 * 1024);
+            printf("Paged mode budget: %lu MB\n", mb);
+        }
         else if (strcmp(cmd, "r") == 0) {
             shrinkToFit(&ed);
             printf("ShrinkToFit: capacity now %zu\n", ed.capacity);
         }
+        else if (strcmp(cmd, "u") == 0) {
+            if (undoEdit(&ed)) printf("Undone. Size now: %zu\n", ed.size);
+            else puts("Nothing to undo.");
+        }
+        else if (strcmp(cmd, "y") == 0) {
+            if (redoEdit(&ed)) printf("Redone. Size now: %zu\n", ed.size);
+            else puts("Nothing to redo.");
+        }
+        else if (strcmp(cmd, "hd") == 0) {
+            long depth;
+            if (parseNumber(rest, &depth) != 0 || depth < 0) {
+                fprintf(stderr, "Invalid depth\n");
+                continue;
+            }
+            setHistoryDepth(&ed, (size_t)depth);
+            printf("History depth now %zu (%zu edits kept)\n", ed.history.depth, ed.history.undoGroups);
+        }
+        else if (strcmp(cmd, "f") == 0) {
+            if (*rest == '\0') {
+                fprintf(stderr, "Usage: f <pattern>\n");
+                continue;
+            }
+            searchLines(&ed, rest);
+        }
+        else if (strcmp(cmd, "x") == 0) {
+            char *from, *to;
+            if (splitReplace(rest, &from, &to) != 0) {
+                fprintf(stderr, "Usage: x <old> [new]\n");
+                continue;
+            }
+            size_t lines;
+            size_t n = replaceAll(&ed, from, to, &lines);
+            printf("Replaced %zu occurrence%s in %zu line%s\n", n, n == 1 ? "" : "s", lines, lines == 1 ? "" : "s");
+        }
+        else if (strcmp(cmd, "as") == 0) {
+            char *end;
+            unsigned long seconds = strtoul(rest, &end, 10);
+            if (end == rest || *end) {
+                fprintf(stderr, "Usage: as <seconds>\n");
+                continue;
+            }
+            if (setAutosaveInterval(&ed, (unsigned)seconds) == 0) {
+                if (seconds) printf("Autosaving every %lu s\n", seconds);
+                else puts("Autosave off.");
+            }
+        }
+        else if (strcmp(cmd, "st") == 0) {
+            printStatus(&ed);
+            if (ed.pager) printPagerStats(&ed);
+        }
+        else if (strcmp(cmd, "m") == 0) {
+            printArenaStats(&ed.arena);
+        }
         else if (strcmp(cmd, "q") == 0) {
             break;
         }
@@ -298,14 +2139,18 @@ int main(void)
         }
         else {
             printf("Unknown command '%s'. Type 'h' for help.\n", cmd);
-            int c; while ((c = getchar()) != '\n' && c != EOF);
         }
     }
 
+    free(args);
+    unlockEditor(&ed);
+    stopAutosave(&ed);
     freeAll(&ed);
+    printArenaStats(&ed.arena);
     printf("Exited. Memory freed.\n");
     return 0;
 }
+#endif
 
 /*  MEMORY MANAGEMENT EXPLANATION
 Why dynamic allocation is more efficient than fixed-size rows.
@@ -315,4 +2160,10 @@ amount of text the user enters instead of reserving a large buffer for every row
 This reduces wasted memory, allows the editor to handle lines of any length, and lets the program grow or
 shrink its storage as needed. With fixed-size rows, space is consumed even for short lines,
 and very long lines cannot fit, making the program less flexible and less memory-efficient.
-*/
\ No newline at end of file
+*/
+/*  LINE ARENA
+Line text is no longer malloc'd one line at a time. Each line is rounded up to a power-of-two size class and
+carved out of a 64 KB slab for that class, so loading a file costs one malloc per slab instead of one per line.
+Deleted lines go onto a per-class free list and are reused by the next insert of a similar size, and reloading
+or quitting hands every slab back in one sweep. The 'm' command prints the allocation and free counts.
+*/
@@ -0,0 +1,195 @@
+#ifndef PF_ASSIGNMENT3_TASK5_H
+#define PF_ASSIGNMENT3_TASK5_H
+
+/* Line editor library. Build the program without its command loop with
+ * -DPF_LIBRARY to link these functions into another program. Only the
+ * print* functions write to stdout; the rest report through return values
+ * or a LineSink. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PATH_CAP 256
+#define ARENA_MIN_SHIFT 4
+#define ARENA_MAX_SHIFT 12
+#define ARENA_CLASSES (ARENA_MAX_SHIFT - ARENA_MIN_SHIFT + 1)
+
+typedef struct ArenaChunk {
+    struct ArenaChunk *prev, *next;
+} ArenaChunk;
+
+typedef struct {
+    uint32_t cap;      /* usable bytes after the header */
+    uint32_t cls;      /* size class index, or ARENA_LARGE */
+} ArenaBlock;
+
+typedef struct {
+    ArenaChunk *chunks;                  /* every slab and large block */
+    char *cursor[ARENA_CLASSES];         /* bump pointer in the current slab */
+    size_t left[ARENA_CLASSES];          /* bytes left in the current slab */
+    void *freeList[ARENA_CLASSES];       /* blocks released by deleteLine */
+    size_t lineAllocs, lineFrees;        /* arenaAlloc / arenaFree calls */
+    size_t slabAllocs, largeAllocs;      /* malloc calls made by the arena */
+    size_t sysFrees;                     /* free calls made by the arena */
+    size_t bytesReserved;
+} LineArena;
+
+typedef struct {
+    char *text;        /* not NUL-terminated when it points into the mapping */
+    size_t len;
+} Line;
+
+typedef enum { UNDO_INSERT, UNDO_DELETE, UNDO_REPLACE } UndoKind;
+
+typedef struct {
+    UndoKind kind;
+    size_t group;      /* records written by one command share a group */
+    size_t index;
+    Line line;         /* the inserted or deleted line, or the other version of a replaced one */
+} UndoRecord;
+
+/* Operation log: [start, undoEnd) can be undone, [undoEnd, end) redone. */
+typedef struct {
+    UndoRecord *recs;
+    size_t start, undoEnd, end, cap;
+    size_t groupSeq, curGroup, openDepth;
+    size_t undoGroups;     /* commands that can currently be undone */
+    size_t depth;          /* most commands kept, 0 disables history */
+    size_t bytes;          /* records plus the text they hold */
+} UndoHistory;
+
+typedef struct {
+    off_t offset;          /* first byte of the window's lines in the file */
+    size_t bytes;          /* bytes they occupy there, newlines included */
+    size_t count;          /* lines in the window now */
+    Line *lines;           /* NULL while the window is not resident */
+    size_t cap;
+    char *buf;             /* file bytes that clean lines point into */
+    size_t bufLen;
+    size_t mem;            /* resident bytes charged to the budget */
+    int dirty;             /* edited since the last save; never evicted */
+    unsigned long lastUse;
+} Window;
+
+typedef struct {
+    int fd;
+    int endsWithNewline;
+    Window *wins;
+    size_t winCount;
+    size_t totalLines;
+    size_t budget;         /* resident bytes before clean windows are evicted */
+    size_t resident;
+    size_t loads, evictions;
+    unsigned long clock;
+} Pager;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;      /* held by the command loop while it edits */
+    pthread_cond_t wake, idle;
+    int running, stop;
+    unsigned interval;         /* seconds between autosaves, 0 = off */
+    int busy;                  /* a snapshot is being written */
+    Line *snapLines;           /* line table it is writing, shared until the editor changes it */
+    char **deferred;           /* text released while busy */
+    size_t deferredCount, deferredCap;
+    size_t savedChanges;       /* edit counter at the last autosave */
+    size_t saves;
+    time_t lastTime;
+    double lastSeconds;
+    size_t lastLines;
+    int lastOk;
+    char lastTarget[PATH_CAP + 16];
+} Autosave;
+
+typedef struct {
+    Line *lines;
+    size_t size;       
+    size_t capacity;   
+    LineArena arena;
+    char *map;         /* file mapped by 'lm', referenced in place */
+    size_t mapLen;
+    dev_t mapDev;
+    ino_t mapIno;
+    char path[PATH_CAP];   /* file last loaded or saved, "" if none */
+    struct stat diskStat;  /* path as we left it, to spot outside changes */
+    int diskCanonical;     /* path holds exactly the lines, each ending in '\n' */
+    size_t dirtyFrom;      /* first line changed since then, SIZE_MAX if clean */
+    size_t dirtyTo;        /* one past the last changed line */
+    int layoutShifted;     /* a change moved the bytes of every later line */
+    off_t *lineOffsets;    /* offset in path of every OFFSET_STRIDE-th line, while canonical */
+    size_t offsetCap;
+    UndoHistory history;
+    size_t changes;        /* bumped on every edit */
+    Autosave autosave;
+    Pager *pager;          /* set while a file is open with 'lp' */
+    size_t pagerBudget;
+} Editor;
+
+/* Receives one line; number is 1-based and text is not NUL-terminated. */
+typedef void (*LineSink)(void *ctx, size_t number, const char *text, size_t len);
+
+void initEditor(Editor *ed);
+void freeAll(Editor *ed);
+size_t bufferLines(const Editor *ed);
+
+/* Editing; indexes are 0-based. Each call is one undo step. */
+void insertLine(Editor *ed, size_t index, const char *text);
+void deleteLine(Editor *ed, size_t index);
+void insertLines(Editor *ed, size_t index, const Line *lines, size_t count);
+void deleteLines(Editor *ed, size_t index, size_t count);
+size_t replaceAll(Editor *ed, const char *from, const char *to, size_t *linesChanged);
+void historyBeginGroup(Editor *ed);
+void historyEndGroup(Editor *ed);
+void setHistoryDepth(Editor *ed, size_t depth);
+int undoEdit(Editor *ed);
+int redoEdit(Editor *ed);
+void shrinkToFit(Editor *ed);
+
+/* Files; these return 0 on success and -1 after reporting the error. */
+int loadFromFile(Editor *ed, const char *filename);
+int loadMappedFile(Editor *ed, const char *filename);
+int openPagedFile(Editor *ed, const char *filename, size_t budget);
+void closePager(Editor *ed);
+void setPagerBudget(Editor *ed, size_t bytes);
+int saveToFile(Editor *ed, const char *filename);
+
+/* Background saves; hold the editor lock while editing from another thread. */
+int setAutosaveInterval(Editor *ed, unsigned seconds);
+void stopAutosave(Editor *ed);
+void lockEditor(Editor *ed);
+void unlockEditor(Editor *ed);
+
+/* Hands lines first..last (1-based, clamped to the buffer) to sink in
+ * order; returns how many it visited. */
+size_t visitLines(Editor *ed, size_t first, size_t last, LineSink sink, void *ctx);
+
+/* Hands every line containing pattern to sink unless it is NULL; returns
+ * the number of matching lines. */
+size_t searchBuffer(Editor *ed, const char *pattern, LineSink sink, void *ctx);
+
+/* Runs editor commands read from in; returns 0 if every command succeeded. */
+int runBatch(Editor *ed, FILE *in, const char *scriptName);
+
+/* Printing versions used by the interactive program. */
+void printAllLines(Editor *ed);
+void printLineRange(Editor *ed, size_t first, size_t last);
+void searchLines(Editor *ed, const char *pattern);
+void printStatus(const Editor *ed);
+void printArenaStats(const LineArena *a);
+void printPagerStats(const Editor *ed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,31 +1,386 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <time.h> 
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "pf-assignment3-task6.h"
 
-#define DATAFILE "members.dat"
-#define NAME_LEN 100
-#define DATE_LEN 11  
 #define INITIAL_CAPACITY 8
+#define SEGMENT_SHIFT 10
+#define SEGMENT_RECORDS ((size_t)1 << SEGMENT_SHIFT)   // records per segment of the in-memory table
+#define ID_INDEX_MIN_CAPACITY 16
+#define JOURNAL_SUFFIX ".journal"
+#define REDO_SUFFIX ".redo"
+#define REDO_MAGIC 0x4F444552u      // "REDO"
+#define IDX_SUFFIX ".idx"
+#define IDX_MAGIC "FMIX"
+#define IDX_VERSION 1
+#define POOL_PAGE_SIZE 4096         // buffer pool frame; an id index page, or PAGE_RECORDS records
+#define POOL_DEFAULT_PAGES 256      // 1 MiB of frames unless -P says otherwise
+#define POOL_MIN_PAGES 8            // enough for one operation's pages plus the CLOCK hand's slack
+#define REDO_END UINT32_MAX         // run marker that precedes the redo log trailer
+#define JOURNAL_MAGIC 0x324E524Au   // "JRN2", DiskRecord payload
+#define JOURNAL_MAGIC_V1 0x4C4E524Au // "JRNL", full Student payload (read only)
+#define JOURNAL_COMPACT_MIN 1024    // never compact a journal shorter than this
+#define TOMBSTONE_ID INT_MIN        // id of a deleted slot awaiting reuse
+#define TOMBSTONE_COMPACT_MIN 64    // fewer dead slots than this are never compacted
+#define TOMBSTONE_COMPACT_RATIO 4   // compact once over 1/4 of the slots are dead
+#define DB_MAGIC "FMDB"
+#define DB_VERSION 2
+#define ENUM_NONE 0xFF              // stored for a string that is not in its table
+#define ENCODE_CHUNK 1024           // records encoded per write on save
+#define DATE_PENDING_MAX 256        // unsorted date index inserts before a merge
+#define GROUP_COMMIT_MAX 4096       // pending records that force a commit
+#define GROUP_COMMIT_WINDOW_MS 10   // oldest pending record waits at most this long
+#define JOURNAL_BUFFER (1 << 20)    // stdio buffer that turns a batch into one write
+#define LOAD_CHUNK_RECORDS 65536   // records per read when the file cannot be mapped
+#define LOAD_PARALLEL_MIN 65536    // records per decode thread, at least
+#define LOAD_MAX_THREADS 16
+#define LEGACY_SUFFIX ".v1"         // original file kept when converting it would lose data
+#define LEGACY_ERRORS_SHOWN 20      // lossy legacy records printed before only counting
+#define CSV_BLOCK (1 << 20)         // bytes read or buffered per CSV block
+#define CSV_FIELDS 7                // id,name,batch,membership,regDate,dob,interest
+#define CSV_ERRORS_SHOWN 20         // rejected rows printed before only counting
+#define BENCH_PRELOAD_CHUNK 65536   // mock records built per addStudents call while preloading
+#define FAULT_SECTOR 512            // disks write whole sectors atomically, nothing larger
+#define FAULT_EXIT 86               // exit status of a child killed at its fault point
+#define CRASH_GROUP 8               // crash-test operations per committed batch
+#define SERVER_DEFAULT_THREADS 8
+#define SERVER_MAX_THREADS 64
+#define SERVER_QUEUE_MAX 256        // accepted connections waiting for a worker
+#define LOADGEN_SEED_RECORDS 100    // records each load generator connection registers first
 
-// --- Data Structure ---
+// --- On-Disk Format (version 2) ---
+// members.dat is a FileHeader followed by `count` DiskRecords. Batch,
+// membership and interest are stored as their index in the name tables and
+// dates as YYYYMMDD integers, so a record takes 116 bytes instead of 176.
+// Files without the header are the original raw Student arrays and are
+// rewritten in this format the first time they are loaded.
 typedef struct {
-    int id;                     
-    char name[NAME_LEN];        
-    char batch[32];             
-    char membership[8];         
-    char regDate[DATE_LEN];     
-    char dob[DATE_LEN];         
-    char interest[8];           
-} Student;
+    int32_t id;
+    char name[NAME_LEN];
+    uint8_t batch;              // index into batchNames
+    uint8_t membership;         // index into membershipNames
+    uint8_t interest;           // index into interestNames
+    uint8_t reserved;
+    uint32_t regDate;           // YYYYMMDD, 0 if unset
+    uint32_t dob;               // YYYYMMDD, 0 if unset
+} DiskRecord;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;        // sizeof(DiskRecord) when the file was written
+    uint32_t count;             // records that follow, tombstones included
+    uint32_t checksum;          // wrapping sum of record_checksum() over every record
+    uint32_t headerChecksum;    // FNV-1a of the fields above
+} FileHeader;
+
+static const char *const batchNames[] = { "CS", "SE", "Cyber Security", "AI" };
+static const char *const membershipNames[] = { "IEEE", "ACM" };
+static const char *const interestNames[] = { "IEEE", "ACM", "Both" };
+#define NAME_COUNT(table) (sizeof(table) / sizeof((table)[0]))
 
 // --- Global Data ---
-Student *students = NULL;
+// Records live in fixed segments that are never moved once allocated, so a
+// Student * stays valid as the table grows and an append never copies old
+// records. Growing `segments` copies only the directory of pointers.
+Student **segments = NULL;
+size_t segmentCount = 0;
+size_t segmentSlots = 0;
 size_t studentCount = 0;
-size_t studentCapacity = 0;
+size_t studentCapacity = 0;         // segmentCount * SEGMENT_RECORDS
+
+static inline Student *student_at(size_t slot) {
+    return &segments[slot >> SEGMENT_SHIFT][slot & (SEGMENT_RECORDS - 1)];
+}
+
+// Contiguous records from `slot` up to `end` or the end of its segment, whichever comes first
+static inline Student *student_run(size_t slot, size_t end, size_t *n) {
+    size_t left = SEGMENT_RECORDS - (slot & (SEGMENT_RECORDS - 1));
+    *n = end - slot < left ? end - slot : left;
+    return student_at(slot);
+}
+
+// Open-addressing index from student id to slot in `students` (slot -1 = empty)
+typedef struct {
+    int id;
+    long slot;
+} IdEntry;
+
+static IdEntry *idIndex = NULL;
+static size_t idIndexCapacity = 0;   // always a power of two
+static size_t idIndexCount = 0;
+
+// --- Journal ---
+// Every add, update and delete since the last full save is appended to
+// <datafile>.journal instead of rewriting the whole database. Each entry
+// either puts a complete record or deletes an id, so replaying the journal
+// over the base file is idempotent.
+enum { JOURNAL_PUT = 1, JOURNAL_DELETE = 2 };
+
+typedef struct {
+    uint32_t magic;
+    uint32_t op;
+    int32_t id;
+    uint32_t checksum;          // covers op, id and the record that follows a PUT
+} JournalHeader;
+
+static FILE *journalFile = NULL;
+static size_t journalEntries = 0;
+
+// --- Storage Mode ---
+// STORAGE_JOURNAL logs mutations as above. STORAGE_INPLACE keeps members.dat
+// an exact image of `students`, so slot idx lives at record_offset(idx)
+// and is rewritten there with pwrite + fdatasync.
+//
+// A commit can rewrite many slots (a shift delete moves every later record),
+// so in-place writes are staged and a commit first writes them to
+// <datafile>.redo: a header with the commit's sequence number, runs of
+// consecutive slots, then the new file header and an FNV-1a of everything
+// before it. Only once that log is synced are the slots rewritten. After a
+// crash the log is either incomplete, over an untouched file, or complete,
+// and loadDatabase applies it again. Each commit overwrites the log from the
+// start; the sequence number keeps a new head and an old tail from checking out.
+//
+// STORAGE_PAGED never loads members.dat; see Paged Storage below. The
+// STORAGE_* values are in the header.
+
+typedef struct {
+    uint32_t magic;             // REDO_MAGIC
+    uint32_t seq;               // commits since the log was opened
+} RedoHeader;
+
+typedef struct {
+    uint32_t first;             // slot of the first record in the run, REDO_END for the trailer
+    uint32_t count;
+} RedoRun;
+
+typedef struct {
+    RedoRun end;                // { REDO_END, 0 }
+    FileHeader header;          // the data file's header once the runs are applied
+    uint32_t checksum;          // FNV-1a of the log up to this field
+} RedoTrailer;
+
+static int storageMode = STORAGE_JOURNAL;
+static int dataFd = -1;         // members.dat, open read/write in in-place mode
+static int redoFd = -1;         // its redo log, open alongside it
+static uint32_t redoSeq = 0;
+static FileHeader dataHeader;   // header of the file behind dataFd
+static int baseDamaged = 0;     // last load found a checksum or length mismatch
+static int legacyHeld = 0;      // a lossy legacy file could not be kept aside; never overwrite it
+static size_t pagedCount = 0;   // paged mode: slots in members.dat, tombstones included
+static size_t pagedLive = 0;    // paged mode: ids in the on-disk index
+
+// --- Durability ---
+// Mutations are written at the next commit rather than one syscall each:
+//   DURABILITY_NONE   commits hand the data to the OS but never fsync
+//   DURABILITY_GROUP  each commit ends with one fdatasync
+//   DURABILITY_SYNC   every record is committed (and fdatasynced) on its own
+// A commit happens when a batch ends, when GROUP_COMMIT_MAX records are
+// pending, when the oldest pending record is older than the commit window,
+// and after every interactive command.
+enum { DURABILITY_NONE, DURABILITY_GROUP, DURABILITY_SYNC };
+
+static const char *const durabilityNames[] = { "none", "group", "sync" };
+static int durability = DURABILITY_NONE;
+static long commitWindowMs = GROUP_COMMIT_WINDOW_MS;
+static int batchDepth = 0;
+static size_t pendingWrites = 0;
+static struct timespec firstPendingAt;
+
+// In-place writes waiting for the next commit, in the order they were made
+typedef struct {
+    uint32_t slot;
+    uint32_t seq;
+    DiskRecord rec;
+} StagedWrite;
+
+static StagedWrite *staged = NULL;
+static size_t stagedCount = 0;
+static size_t stagedCapacity = 0;
+static size_t stagedFileCount = 0;  // records the data file holds once the staged writes land
+
+// --- Delete Mode ---
+// DELETE_SHIFT keeps registration order by moving every later record down.
+// DELETE_SWAP moves the last record into the hole. DELETE_TOMBSTONE only
+// marks the slot dead and pushes it on `freeSlots` for the next add to reuse.
+// Tombstones exist only in tombstone mode; other modes compact them at startup.
+enum { DELETE_SHIFT, DELETE_SWAP, DELETE_TOMBSTONE };
+
+static int deleteMode = DELETE_SHIFT;
+static size_t *freeSlots = NULL;    // dead slots, reused last-in first-out
+static size_t freeSlotCount = 0;    // also the number of tombstones in `students`
+static size_t freeSlotCapacity = 0;
+
+// --- Bitmap Indexes ---
+// One bitset per batch, membership and interest value; bit i is set when
+// slot i holds a live record with that value. Reports AND/OR these a word
+// at a time instead of comparing strings record by record.
+static uint64_t *batchBits[NAME_COUNT(batchNames)];
+static uint64_t *membershipBits[NAME_COUNT(membershipNames)];
+static uint64_t *interestBits[NAME_COUNT(interestNames)];
+static size_t bitmapWords = 0;      // words allocated per bitset
+
+// --- Date Indexes ---
+// Sorted (date, id) arrays over regDate and dob, with dates packed as
+// YYYYMMDD so they compare as integers. New entries collect in a small
+// unsorted pending buffer that queries scan directly; it is merged into the
+// sorted array when full. Inside a batch the buffer keeps growing instead,
+// and the whole batch is merged once when it ends. Deleted entries are only
+// marked dead and are dropped by the next merge. Keys are ids, so slot moves
+// never touch them.
+typedef struct {
+    uint32_t key;               // YYYYMMDD
+    int32_t id;
+    uint8_t dead;
+} DateEntry;
+
+typedef struct {
+    DateEntry *sorted;
+    size_t sortedCount;
+    size_t deadCount;
+    DateEntry *pending;
+    size_t pendingCount;
+    size_t pendingCapacity;
+} DateIndex;
+
+static DateIndex regDateIndex;
+static DateIndex dobIndex;
+
+// --- Fault Injection ---
+// Every write, flush, sync, truncation, rename and removal the database
+// makes on its files goes through an io_* shim. Normally a shim only counts
+// calls. The crash test (-F) arms `faultAt` in a child process, and the call
+// that reaches that count simulates a crash there. A write that crosses a
+// sector boundary is torn at the first one; any other call dies before it
+// does anything. _exit then also drops whatever stdio still buffers.
+static long faultCalls = 0;
+static long faultAt = 0;        // 0 = disarmed
+
+static int fault_point(void) {
+    return ++faultCalls == faultAt;
+}
+
+// Bytes of a write at `off` that land before its first sector boundary, or 0 if it crosses none
+static size_t fault_torn_length(off_t off, size_t len) {
+    size_t next = FAULT_SECTOR - (size_t)(off % FAULT_SECTOR);
+    return next < len ? next : 0;
+}
+
+static size_t io_fwrite(const void *ptr, size_t size, size_t n, FILE *f) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return fwrite(ptr, size, n, f);
+}
+
+static int io_fflush(FILE *f) {
+    if (fault_point()) {
+        // Flush everything, then cut the new bytes back to where a sector boundary would tear them
+        struct stat before, after;
+        if (fstat(fileno(f), &before) == 0 && fflush(f) == 0 && fstat(fileno(f), &after) == 0 &&
+            after.st_size > before.st_size) {
+            size_t torn = fault_torn_length(before.st_size, (size_t)(after.st_size - before.st_size));
+            if (ftruncate(fileno(f), before.st_size + (off_t)torn) != 0) perror("ftruncate");
+        }
+        _exit(FAULT_EXIT);
+    }
+    return fflush(f);
+}
+
+static ssize_t io_pwrite(int fd, const void *buf, size_t len, off_t off) {
+    if (fault_point()) {
+        size_t torn = fault_torn_length(off, len);
+        if (torn && pwrite(fd, buf, torn, off) < 0) perror("pwrite");
+        _exit(FAULT_EXIT);
+    }
+    return pwrite(fd, buf, len, off);
+}
+
+static int io_fsync(int fd) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return fsync(fd);
+}
+
+static int io_fdatasync(int fd) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return fdatasync(fd);
+}
+
+static int io_ftruncate(int fd, off_t len) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return ftruncate(fd, len);
+}
+
+static int io_truncate(const char *path, off_t len) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return truncate(path, len);
+}
+
+static int io_rename(const char *from, const char *to) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return rename(from, to);
+}
+
+static int io_remove(const char *path) {
+    if (fault_point()) _exit(FAULT_EXIT);
+    return remove(path);
+}
+
+// Makes a rename in the directory holding `path` durable
+static int sync_parent_dir(const char *path) {
+    char dir[512];
+    const char *slash = strrchr(path, '/');
+    snprintf(dir, sizeof(dir), "%.*s", slash ? (int)(slash - path) + 1 : 1, slash ? path : ".");
+    int fd = open(dir, O_RDONLY);
+    if (fd < 0) return -1;
+    int rc = io_fsync(fd);
+    close(fd);
+    return rc;
+}
 
 // --- Utility Functions ---
+// Returns 0 when len bytes arrived, 1 on a clean EOF before any byte, -1 on error
+static int read_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    size_t got = 0;
+    while (got < len) {
+        ssize_t n = read(fd, p + got, len - got);
+        if (n == 0) return got == 0 ? 1 : -1;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
 
 // Removes trailing newline from a string
 static void trim_newline(char *s) {
@@ -35,28 +390,140 @@ static void trim_newline(char *s) {
     if (s[n-1] == '\n') s[n-1] = '\0';
 }
 
-// Resizes the student array if necessary
+// Adds segments until minCap records fit; existing records stay where they are
 static void ensure_capacity(size_t minCap) {
-    if(studentCapacity >= minCap) return;
-    size_t newCap = studentCapacity ? studentCapacity : INITIAL_CAPACITY;
-    while (newCap < minCap) newCap <<= 1;
+    while (studentCapacity < minCap) {
+        if (segmentCount == segmentSlots) {
+            size_t newSlots = segmentSlots ? segmentSlots * 2 : INITIAL_CAPACITY;
+            Student **tmp = realloc(segments, newSlots * sizeof(Student *));
+            if (!tmp) {
+                perror("realloc");
+                fprintf(stderr, "Fatal: Out of memory while resizing student array.\n");
+                exit(EXIT_FAILURE);
+            }
+            segments = tmp;
+            segmentSlots = newSlots;
+        }
+        Student *segment = malloc(SEGMENT_RECORDS * sizeof(Student));
+        if (!segment) {
+            perror("malloc");
+            fprintf(stderr, "Fatal: Out of memory while resizing student array.\n");
+            exit(EXIT_FAILURE);
+        }
+        segments[segmentCount++] = segment;
+        studentCapacity += SEGMENT_RECORDS;
+    }
+}
 
-    Student *tmp = realloc(students, newCap * sizeof(Student));
-    if (!tmp) {
-        perror("realloc");
-        fprintf(stderr, "Fatal: Out of memory while resizing student array.\n");
+// Frees trailing segments once two of them are unused; one stays as slack
+// so a delete and add at a segment boundary do not free and reallocate
+static void shrink_capacity(void) {
+    while (segmentCount > 1 && studentCount + 2 * SEGMENT_RECORDS <= studentCapacity) {
+        free(segments[--segmentCount]);
+        studentCapacity -= SEGMENT_RECORDS;
+    }
+}
+
+static void free_segments(void) {
+    for (size_t i = 0; i < segmentCount; ++i) free(segments[i]);
+    free(segments);
+    segments = NULL;
+    segmentCount = segmentSlots = 0;
+    studentCapacity = 0;
+}
+
+// --- Id Index ---
+
+static size_t id_hash(int id) {
+    // Fibonacci hashing spreads sequential ids across the table
+    return (size_t)(((uint32_t)id * 2654435769u) ^ ((uint32_t)id >> 16));
+}
+
+// Returns the table position holding id, or the empty position where it would go
+static size_t id_index_probe(int id) {
+    size_t mask = idIndexCapacity - 1;
+    size_t pos = id_hash(id) & mask;
+    while (idIndex[pos].slot != -1 && idIndex[pos].id != id) pos = (pos + 1) & mask;
+    return pos;
+}
+
+static void id_index_alloc(size_t capacity) {
+    free(idIndex);
+    idIndex = malloc(capacity * sizeof(IdEntry));
+    if (!idIndex) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while building the id index.\n");
         exit(EXIT_FAILURE);
     }
-    students = tmp;
-    studentCapacity = newCap;
+    for (size_t i = 0; i < capacity; ++i) idIndex[i].slot = -1;
+    idIndexCapacity = capacity;
+    idIndexCount = 0;
 }
 
-// Finds the index of a student by ID
-static long findStudentIndexByID(int id) {
+// Records that `id` lives at `slot`, adding it or moving it
+static void id_index_put(int id, size_t slot) {
+    if ((idIndexCount + 1) * 10 > idIndexCapacity * 7) {
+        IdEntry *old = idIndex;
+        size_t oldCapacity = idIndexCapacity;
+        idIndex = NULL;
+        id_index_alloc(oldCapacity ? oldCapacity * 2 : ID_INDEX_MIN_CAPACITY);
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (old[i].slot == -1) continue;
+            idIndex[id_index_probe(old[i].id)] = old[i];
+            idIndexCount++;
+        }
+        free(old);
+    }
+    size_t pos = id_index_probe(id);
+    if (idIndex[pos].slot == -1) idIndexCount++;
+    idIndex[pos].id = id;
+    idIndex[pos].slot = (long)slot;
+}
+
+// Rebuilds the index from the current array
+static void id_index_rebuild(void) {
+    size_t capacity = ID_INDEX_MIN_CAPACITY;
+    while (capacity < studentCount * 2) capacity <<= 1;
+    id_index_alloc(capacity);
     for (size_t i = 0; i < studentCount; ++i) {
-        if (students[i].id == id) return (long)i;
+        int id = student_at(i)->id;
+        if (id != TOMBSTONE_ID) id_index_put(id, i);
+    }
+}
+
+// Removes id, shifting later entries of the probe run back so no tombstones are needed
+static void id_index_remove(int id) {
+    if (idIndexCapacity == 0) return;
+    size_t mask = idIndexCapacity - 1;
+    size_t hole = id_index_probe(id);
+    if (idIndex[hole].slot == -1) return;
+
+    size_t pos = hole;
+    for (;;) {
+        pos = (pos + 1) & mask;
+        if (idIndex[pos].slot == -1) break;
+        size_t home = id_hash(idIndex[pos].id) & mask;
+        // Move the entry back only if the hole lies on its probe path
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            idIndex[hole] = idIndex[pos];
+            hole = pos;
+        }
     }
-    return -1;
+    idIndex[hole].slot = -1;
+    idIndexCount--;
+}
+
+static void id_index_free(void) {
+    free(idIndex);
+    idIndex = NULL;
+    idIndexCapacity = 0;
+    idIndexCount = 0;
+}
+
+// Finds the index of a student by ID
+static long findStudentIndexByID(int id) {
+    if (idIndexCapacity == 0) return -1;
+    return idIndex[id_index_probe(id)].slot;
 }
 
 // Helper function to read a line of input
@@ -72,20 +539,25 @@ static void read_line_input(const char *prompt, char *out, size_t outLen) {
 
 // --- Validation Functions ---
 
+// Position of value in a name table, or ENUM_NONE
+static uint8_t enum_code(const char *const *names, size_t count, const char *value) {
+    if (!value) return ENUM_NONE;
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(names[i], value) == 0) return (uint8_t)i;
+    }
+    return ENUM_NONE;
+}
+
 static int validBatch(const char *batch) {
-    if (!batch) return 0;
-    return (strcmp(batch, "CS") == 0 || strcmp(batch, "SE") == 0 || 
-            strcmp(batch, "Cyber Security") == 0 || strcmp(batch, "AI") == 0);
+    return enum_code(batchNames, NAME_COUNT(batchNames), batch) != ENUM_NONE;
 }
 
 static int validMembership(const char *m) {
-    if (!m) return 0;
-    return (strcmp(m, "IEEE") == 0 || strcmp(m, "ACM") == 0);
+    return enum_code(membershipNames, NAME_COUNT(membershipNames), m) != ENUM_NONE;
 }
 
 static int validInterest(const char *s) {
-    if (!s) return 0;
-    return (strcmp(s, "IEEE") == 0 || strcmp(s, "ACM") == 0 || strcmp(s, "Both") == 0);
+    return enum_code(interestNames, NAME_COUNT(interestNames), s) != ENUM_NONE;
 }
 
 // Checks if a year is a leap year
@@ -94,502 +566,3895 @@ static int is_leap(int year) {
     return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
 }
 
-// Full calendar validation for YYYY-MM-DD format
-static int validDateFormat(const char *d) {
-    if (!d || strlen(d) != 10) return 0;
-    
-    int year, month, day;
-    
-    // 1. Check structure and parse values
-    if (sscanf(d, "%d-%d-%d", &year, &month, &day) != 3) {
-        return 0; // Failed to parse YYYY-MM-DD pattern
+// Parses exactly `len` chars of "YYYY-MM-DD" into YYYYMMDD, or 0 when it is
+// not a real calendar date. The eight digit and two separator checks are
+// OR-ed into one flag and tested once, so good dates take no early exits.
+static uint32_t parse_date(const char *d, size_t len) {
+    if (len != 10) return 0;
+    const unsigned char *u = (const unsigned char *)d;
+    unsigned bad = (u[4] ^ '-') | (u[7] ^ '-');
+    unsigned digits[8];
+    static const unsigned char pos[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i = 0; i < 8; ++i) {
+        digits[i] = u[pos[i]] - (unsigned)'0';
+        bad |= digits[i] > 9;
     }
-    
-    // 2. Check reasonable year range (adjust bounds as needed)
-    if (year < 1900 || year > 2100) return 0; 
-
-    // 3. Check month range
-    if (month < 1 || month > 12) return 0;
+    if (bad) return 0;
 
-    // 4. Check day range based on month and leap year
-    int days_in_month[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    
-    if (month == 2) {
-        if (is_leap(year)) days_in_month[2] = 29;
-    }
-    
-    if (day < 1 || day > days_in_month[month]) return 0;
+    unsigned year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    unsigned month = digits[4] * 10 + digits[5];
+    unsigned day = digits[6] * 10 + digits[7];
+    static const unsigned char daysInMonth[13] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1900 || year > 2100 || month - 1 > 11) return 0;
+    unsigned last = daysInMonth[month] + (month == 2 && is_leap((int)year));
+    if (day - 1 >= last) return 0;
+    return year * 10000 + month * 100 + day;
+}
 
-    return 1;
+// Full calendar validation for YYYY-MM-DD format
+static int validDateFormat(const char *d) {
+    return d && parse_date(d, strlen(d)) != 0;
 }
 
-// --- Core Logic Functions ---
+// --- Record Encoding ---
 
-static void printStudent(const Student *s) {
-    if (!s) return;
-    printf("\nID: %d\nName: %s\nBatch: %s\nMembership: %s\nRegDate: %s\nDOB: %s\nInterest: %s\n",
-           s->id, s->name, s->batch, s->membership, s->regDate, s->dob, s->interest);
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * 16777619u;
+    return h;
 }
 
-int loadDatabase(const char *filename) {
-    FILE *f = fopen(filename, "rb");
-    if (!f) {
-        if (errno == ENOENT) {
-            studentCount = 0;
-            return 0;
+static const char *enum_name(const char *const *names, size_t count, uint8_t code) {
+    return code < count ? names[code] : "";
+}
+
+// "YYYY-MM-DD" -> YYYYMMDD; anything else packs to 0
+static uint32_t pack_date(const char *d) {
+    uint32_t v = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (i == 4 || i == 7) {
+            if (d[i] != '-') return 0;
+            continue;
         }
-        perror("fopen");
-        fprintf(stderr, "Error: could not open '%s' for reading.\n", filename);
-        return -1;
+        if (d[i] < '0' || d[i] > '9') return 0;
+        v = v * 10 + (uint32_t)(d[i] - '0');
     }
+    return d[10] == '\0' ? v : 0;
+}
 
-    studentCount = 0;
-    Student tmp;
-    while (fread(&tmp, sizeof(Student), 1, f) == 1) {
-        ensure_capacity(studentCount + 1);
-        students[studentCount++] = tmp;
+static void unpack_date(uint32_t v, char *out) {
+    if (v == 0 || v > 99991231u) {
+        out[0] = '\0';
+        return;
     }
+    unsigned year = v / 10000, month = v / 100 % 100, day = v % 100;
+    out[0] = (char)('0' + year / 1000);
+    out[1] = (char)('0' + year / 100 % 10);
+    out[2] = (char)('0' + year / 10 % 10);
+    out[3] = (char)('0' + year % 10);
+    out[4] = '-';
+    out[5] = (char)('0' + month / 10);
+    out[6] = (char)('0' + month % 10);
+    out[7] = '-';
+    out[8] = (char)('0' + day / 10);
+    out[9] = (char)('0' + day % 10);
+    out[10] = '\0';
+}
 
-    if (ferror(f)) {
-        perror("fread");
-        fclose(f);
-        return -1;
-    }
+static void encode_record(const Student *s, DiskRecord *r) {
+    memset(r, 0, sizeof(*r));
+    r->id = s->id;
+    memcpy(r->name, s->name, strnlen(s->name, sizeof(r->name) - 1));
+    r->batch = enum_code(batchNames, NAME_COUNT(batchNames), s->batch);
+    r->membership = enum_code(membershipNames, NAME_COUNT(membershipNames), s->membership);
+    r->interest = enum_code(interestNames, NAME_COUNT(interestNames), s->interest);
+    r->regDate = pack_date(s->regDate);
+    r->dob = pack_date(s->dob);
+}
 
-    if (fclose(f) != 0) {
-        perror("fclose");
-        return -1;
-    }
-    return 0;
+// Why encode_record cannot keep s as it is, or NULL if it can. Empty fields
+// survive (they decode back as ""); unknown names and bad dates do not.
+static const char *encode_loss(const Student *s) {
+    if (strnlen(s->name, sizeof(s->name)) >= sizeof(s->name)) return "name is not terminated";
+    if (s->batch[0] && !validBatch(s->batch)) return "unknown batch";
+    if (s->membership[0] && !validMembership(s->membership)) return "unknown membership";
+    if (s->interest[0] && !validInterest(s->interest)) return "unknown interest";
+    if (s->regDate[0] && pack_date(s->regDate) == 0) return "invalid registration date";
+    if (s->dob[0] && pack_date(s->dob) == 0) return "invalid date of birth";
+    return NULL;
 }
 
-int saveDatabase(const char *filename) {
-    char tmpName[512];
-    snprintf(tmpName, sizeof(tmpName), "%s.tmp", filename);
+static void decode_record(const DiskRecord *r, Student *s) {
+    memset(s, 0, sizeof(*s));
+    s->id = r->id;
+    memcpy(s->name, r->name, sizeof(s->name));
+    s->name[sizeof(s->name) - 1] = '\0';
+    strcpy(s->batch, enum_name(batchNames, NAME_COUNT(batchNames), r->batch));
+    strcpy(s->membership, enum_name(membershipNames, NAME_COUNT(membershipNames), r->membership));
+    strcpy(s->interest, enum_name(interestNames, NAME_COUNT(interestNames), r->interest));
+    unpack_date(r->regDate, s->regDate);
+    unpack_date(r->dob, s->dob);
+}
 
-    FILE *f = fopen(tmpName, "wb");
-    if (!f) {
-        perror("fopen");
-        fprintf(stderr, "Error: could not open temporary file for writing.\n");
-        return -1;
-    }
+static uint32_t record_checksum(const DiskRecord *r) {
+    return fnv1a(2166136261u, r, sizeof(*r));
+}
 
-    if (fwrite(students, sizeof(Student), studentCount, f) != studentCount) {
-        perror("fwrite");
-        fclose(f);
-        remove(tmpName);
-        return -1;
+// The file checksum is a plain sum of record checksums so that rewriting one
+// record in place only needs the old and new record, not the whole file.
+static void header_init(FileHeader *h, uint32_t count, uint32_t checksum) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, DB_MAGIC, sizeof(h->magic));
+    h->version = DB_VERSION;
+    h->recordSize = sizeof(DiskRecord);
+    h->count = count;
+    h->checksum = checksum;
+    h->headerChecksum = fnv1a(2166136261u, h, offsetof(FileHeader, headerChecksum));
+}
+
+static int header_valid(const FileHeader *h) {
+    return memcmp(h->magic, DB_MAGIC, sizeof(h->magic)) == 0 &&
+           h->version == DB_VERSION && h->recordSize == sizeof(DiskRecord) &&
+           h->headerChecksum == fnv1a(2166136261u, h, offsetof(FileHeader, headerChecksum));
+}
+
+static off_t record_offset(size_t slot) {
+    return (off_t)(sizeof(FileHeader) + slot * sizeof(DiskRecord));
+}
+
+// --- Bitmap Index Functions ---
+
+static void bitmap_grow_one(uint64_t **bits, size_t newWords) {
+    uint64_t *tmp = realloc(*bits, newWords * sizeof(uint64_t));
+    if (!tmp) {
+        perror("realloc");
+        fprintf(stderr, "Fatal: Out of memory while growing report indexes.\n");
+        exit(EXIT_FAILURE);
     }
+    memset(tmp + bitmapWords, 0, (newWords - bitmapWords) * sizeof(uint64_t));
+    *bits = tmp;
+}
 
-    if (fflush(f) != 0) { perror("fflush"); fclose(f); remove(tmpName); return -1; }
-    if (fclose(f) != 0) { perror("fclose"); remove(tmpName); return -1; }
+// Makes every bitset cover at least `slots` slots
+static void bitmap_reserve(size_t slots) {
+    size_t need = (slots + 63) / 64;
+    if (need <= bitmapWords) return;
+    size_t newWords = bitmapWords ? bitmapWords : 1;
+    while (newWords < need) newWords *= 2;
+    for (size_t v = 0; v < NAME_COUNT(batchNames); ++v) bitmap_grow_one(&batchBits[v], newWords);
+    for (size_t v = 0; v < NAME_COUNT(membershipNames); ++v) bitmap_grow_one(&membershipBits[v], newWords);
+    for (size_t v = 0; v < NAME_COUNT(interestNames); ++v) bitmap_grow_one(&interestBits[v], newWords);
+    bitmapWords = newWords;
+}
 
-    remove(filename); 
-    if (rename(tmpName, filename) != 0) {
-        perror("rename");
-        fprintf(stderr, "Error: could not replace database file.\n");
-        remove(tmpName);
-        return -1;
+static void bitmap_assign(uint64_t *const *bits, size_t values, uint8_t code, size_t slot) {
+    uint64_t bit = 1ull << (slot % 64);
+    for (size_t v = 0; v < values; ++v) {
+        if (v == code) bits[v][slot / 64] |= bit;
+        else bits[v][slot / 64] &= ~bit;
     }
+}
 
-    return 0;
+// Brings the slot's bits in line with its record (all clear for a tombstone or unused slot)
+static void bitmap_set_slot(size_t slot) {
+    bitmap_reserve(slot + 1);
+    const Student *s = student_at(slot);
+    int live = slot < studentCount && s->id != TOMBSTONE_ID;
+    bitmap_assign(batchBits, NAME_COUNT(batchNames),
+                  live ? enum_code(batchNames, NAME_COUNT(batchNames), s->batch) : ENUM_NONE, slot);
+    bitmap_assign(membershipBits, NAME_COUNT(membershipNames),
+                  live ? enum_code(membershipNames, NAME_COUNT(membershipNames), s->membership) : ENUM_NONE, slot);
+    bitmap_assign(interestBits, NAME_COUNT(interestNames),
+                  live ? enum_code(interestNames, NAME_COUNT(interestNames), s->interest) : ENUM_NONE, slot);
 }
 
-int addStudent(const Student *s, const char *filename) {
-    if (!s) return -1;
+// Sizes every bitset for `slots` slots and clears all bits
+static void bitmap_clear(size_t slots) {
+    bitmap_reserve(slots + 1);
+    for (size_t v = 0; v < NAME_COUNT(batchNames); ++v) memset(batchBits[v], 0, bitmapWords * sizeof(uint64_t));
+    for (size_t v = 0; v < NAME_COUNT(membershipNames); ++v) memset(membershipBits[v], 0, bitmapWords * sizeof(uint64_t));
+    for (size_t v = 0; v < NAME_COUNT(interestNames); ++v) memset(interestBits[v], 0, bitmapWords * sizeof(uint64_t));
+}
 
-    if (findStudentIndexByID(s->id) != -1) {
-        fprintf(stderr, "Error: Student ID %d already exists. Registration failed.\n", s->id);
-        return -1;
-    }
-    
-    // Add to file (for persistence)
-    FILE *f = fopen(filename, "ab"); 
-    if (!f) {
-        perror("fopen");
-        fprintf(stderr, "Error: cannot open data file to append.\n");
-        return -1;
+static void bitmap_rebuild(void) {
+    bitmap_clear(studentCount);
+    for (size_t i = 0; i < studentCount; ++i) bitmap_set_slot(i);
+}
+
+static void bitmap_free(void) {
+    for (size_t v = 0; v < NAME_COUNT(batchNames); ++v) { free(batchBits[v]); batchBits[v] = NULL; }
+    for (size_t v = 0; v < NAME_COUNT(membershipNames); ++v) { free(membershipBits[v]); membershipBits[v] = NULL; }
+    for (size_t v = 0; v < NAME_COUNT(interestNames); ++v) { free(interestBits[v]); interestBits[v] = NULL; }
+    bitmapWords = 0;
+}
+
+// Index of the lowest set bit; w must be non-zero
+static unsigned lowest_bit(uint64_t w) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(w);
+#else
+    unsigned n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+#endif
+}
+
+// --- Date Index Functions ---
+
+static int date_entry_cmp(const void *a, const void *b) {
+    const DateEntry *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+// First sorted position not ordered before (key, id)
+static size_t date_lower_bound(const DateIndex *ix, uint32_t key, int32_t id) {
+    size_t lo = 0, hi = ix->sortedCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const DateEntry *m = &ix->sorted[mid];
+        if (m->key < key || (m->key == key && m->id < id)) lo = mid + 1;
+        else hi = mid;
     }
-    if (fwrite(s, sizeof(Student), 1, f) != 1) {
-        perror("fwrite");
-        fclose(f);
-        return -1;
+    return lo;
+}
+
+// Folds the pending buffer into the sorted array and drops dead entries
+static void date_index_merge(DateIndex *ix) {
+    qsort(ix->pending, ix->pendingCount, sizeof(DateEntry), date_entry_cmp);
+    size_t total = ix->sortedCount - ix->deadCount + ix->pendingCount;
+    DateEntry *merged = malloc((total ? total : 1) * sizeof(DateEntry));
+    if (!merged) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while merging a date index.\n");
+        exit(EXIT_FAILURE);
     }
-    if (fclose(f) != 0) {
-        perror("fclose");
-        return -1;
+    size_t i = 0, p = 0, out = 0;
+    while (i < ix->sortedCount || p < ix->pendingCount) {
+        if (i < ix->sortedCount && ix->sorted[i].dead) { i++; continue; }
+        if (p >= ix->pendingCount ||
+            (i < ix->sortedCount && date_entry_cmp(&ix->sorted[i], &ix->pending[p]) < 0)) {
+            merged[out++] = ix->sorted[i++];
+        } else {
+            merged[out++] = ix->pending[p++];
+        }
     }
-    
-    // Add to in-memory array
-    ensure_capacity(studentCount + 1);
-    students[studentCount++] = *s;
-    return 0;
+    free(ix->sorted);
+    ix->sorted = merged;
+    ix->sortedCount = out;
+    ix->deadCount = 0;
+    ix->pendingCount = 0;
 }
 
-int updateStudent(int studentID) {
-    long idx = findStudentIndexByID(studentID);
-    if (idx == -1) {
-        fprintf(stderr, "Student ID %d not found.\n", studentID);
-        return -1;
+static void date_index_insert(DateIndex *ix, uint32_t key, int32_t id) {
+    if (key == 0) return;   // unset or malformed date: not indexed
+    if (ix->pendingCount >= DATE_PENDING_MAX && batchDepth == 0) date_index_merge(ix);
+    if (ix->pendingCount == ix->pendingCapacity) {
+        size_t newCap = ix->pendingCapacity ? ix->pendingCapacity * 2 : DATE_PENDING_MAX;
+        DateEntry *tmp = realloc(ix->pending, newCap * sizeof(DateEntry));
+        if (!tmp) {
+            perror("realloc");
+            fprintf(stderr, "Fatal: Out of memory while growing a date index.\n");
+            exit(EXIT_FAILURE);
+        }
+        ix->pending = tmp;
+        ix->pendingCapacity = newCap;
     }
+    DateEntry e = { key, id, 0 };
+    ix->pending[ix->pendingCount++] = e;
+}
 
-    Student *s = &students[idx];
-    char buf[128];
+static void date_index_remove(DateIndex *ix, uint32_t key, int32_t id) {
+    if (key == 0) return;
+    for (size_t p = 0; p < ix->pendingCount; ++p) {
+        if (ix->pending[p].key == key && ix->pending[p].id == id) {
+            ix->pending[p] = ix->pending[--ix->pendingCount];
+            return;
+        }
+    }
+    size_t pos = date_lower_bound(ix, key, id);
+    if (pos < ix->sortedCount && ix->sorted[pos].key == key && ix->sorted[pos].id == id &&
+        !ix->sorted[pos].dead) {
+        ix->sorted[pos].dead = 1;
+        // Too many dead entries slow every range scan; merge them away
+        if (++ix->deadCount * 4 > ix->sortedCount) date_index_merge(ix);
+    }
+}
 
-    printf("Current record:\n");
-    printStudent(s);
+static void date_index_free(DateIndex *ix) {
+    free(ix->sorted);
+    free(ix->pending);
+    ix->sorted = NULL;
+    ix->pending = NULL;
+    ix->sortedCount = ix->deadCount = ix->pendingCount = ix->pendingCapacity = 0;
+}
 
-    // Clear buffer after previous scanf (if any)
-    int c; while ((c = getchar()) != '\n' && c != EOF); 
-    
-    read_line_input("Enter new batch (CS / SE / Cyber Security / AI) or press Enter to keep: ", buf, sizeof(buf));
-    if (strlen(buf) > 0) {
-        if (!validBatch(buf)) {
-            fprintf(stderr, "Invalid batch string. Update aborted.\n");
-            return -1;
-        }
-        strncpy(s->batch, buf, sizeof(s->batch)-1);
-        s->batch[sizeof(s->batch)-1] = '\0';
+static void date_index_rebuild(DateIndex *ix, size_t dateField) {
+    date_index_free(ix);
+    ix->sorted = malloc((studentCount ? studentCount : 1) * sizeof(DateEntry));
+    if (!ix->sorted) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while building a date index.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < studentCount; ++i) {
+        const Student *s = student_at(i);
+        uint32_t key = pack_date((const char *)s + dateField);
+        if (s->id == TOMBSTONE_ID || key == 0) continue;
+        DateEntry e = { key, s->id, 0 };
+        ix->sorted[ix->sortedCount++] = e;
     }
+    qsort(ix->sorted, ix->sortedCount, sizeof(DateEntry), date_entry_cmp);
+}
 
-    read_line_input("Enter new membership (IEEE / ACM) or press Enter to keep: ", buf, sizeof(buf));
-    if (strlen(buf) > 0) {
-        if (!validMembership(buf)) {
-            fprintf(stderr, "Invalid membership. Update aborted.\n");
-            return -1;
+static void date_indexes_add(const Student *s) {
+    date_index_insert(&regDateIndex, pack_date(s->regDate), s->id);
+    date_index_insert(&dobIndex, pack_date(s->dob), s->id);
+}
+
+// Merges what a finished batch left pending
+static void date_indexes_settle(void) {
+    if (regDateIndex.pendingCount > DATE_PENDING_MAX) date_index_merge(&regDateIndex);
+    if (dobIndex.pendingCount > DATE_PENDING_MAX) date_index_merge(&dobIndex);
+}
+
+static void date_indexes_drop(const Student *s) {
+    date_index_remove(&regDateIndex, pack_date(s->regDate), s->id);
+    date_index_remove(&dobIndex, pack_date(s->dob), s->id);
+}
+
+// Collects ids with from <= date <= to, in date order, into a malloc'd array
+static int32_t *date_index_range(const DateIndex *ix, uint32_t from, uint32_t to, size_t *countOut) {
+    size_t start = date_lower_bound(ix, from, INT32_MIN);
+    size_t cap = 16, count = 0;
+    DateEntry *hits = malloc(cap * sizeof(DateEntry));
+    if (!hits) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    size_t sortedHits = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t n = pass == 0 ? ix->sortedCount : ix->pendingCount;
+        for (size_t i = pass == 0 ? start : 0; i < n; ++i) {
+            const DateEntry *e = pass == 0 ? &ix->sorted[i] : &ix->pending[i];
+            if (pass == 0 && e->key > to) break;
+            if (e->dead || e->key < from || e->key > to) continue;
+            if (count == cap) {
+                cap *= 2;
+                DateEntry *tmp = realloc(hits, cap * sizeof(DateEntry));
+                if (!tmp) {
+                    perror("realloc");
+                    exit(EXIT_FAILURE);
+                }
+                hits = tmp;
+            }
+            hits[count++] = *e;
         }
-        strncpy(s->membership, buf, sizeof(s->membership)-1);
-        s->membership[sizeof(s->membership)-1] = '\0';
+        if (pass == 0) sortedHits = count;
     }
+    // Sorted hits are already in order; pending ones force a re-sort
+    if (count > sortedHits) qsort(hits, count, sizeof(DateEntry), date_entry_cmp);
+
+    int32_t *ids = malloc((count ? count : 1) * sizeof(int32_t));
+    if (!ids) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; ++i) ids[i] = hits[i].id;
+    free(hits);
+    *countOut = count;
+    return ids;
+}
+
+// Rebuilds every slot-keyed index after the array was reloaded or compacted
+static void indexes_rebuild(void) {
+    id_index_rebuild();
+    bitmap_rebuild();
+}
+
+// --- In-Memory Mutations ---
+
+static int is_tombstone(const Student *s) {
+    return s->id == TOMBSTONE_ID;
+}
+
+// Number of real records (slots minus tombstones)
+static size_t live_count(void) {
+    if (storageMode == STORAGE_PAGED) return pagedLive;
+    return studentCount - freeSlotCount;
+}
+
+static void free_slot_push(size_t slot) {
+    if (freeSlotCount == freeSlotCapacity) {
+        size_t newCap = freeSlotCapacity ? freeSlotCapacity * 2 : INITIAL_CAPACITY;
+        size_t *tmp = realloc(freeSlots, newCap * sizeof(size_t));
+        if (!tmp) {
+            perror("realloc");
+            fprintf(stderr, "Fatal: Out of memory while tracking free slots.\n");
+            exit(EXIT_FAILURE);
+        }
+        freeSlots = tmp;
+        freeSlotCapacity = newCap;
+    }
+    freeSlots[freeSlotCount++] = slot;
+}
+
+// Slot the next new record will occupy: the latest tombstone, else the end
+static size_t next_free_slot(void) {
+    return freeSlotCount ? freeSlots[freeSlotCount - 1] : studentCount;
+}
+
+// Drops every tombstone, keeping the order of the live records
+static void compact_in_memory(void) {
+    if (freeSlotCount == 0) return;
+    size_t out = 0;
+    for (size_t i = 0; i < studentCount; ++i) {
+        const Student *s = student_at(i);
+        if (!is_tombstone(s)) *student_at(out++) = *s;
+    }
+    studentCount = out;
+    freeSlotCount = 0;
+    indexes_rebuild();
+}
+
+// Adds a record in the next free slot, or replaces the one with the same id
+static void put_in_memory(const Student *s) {
+    long idx = findStudentIndexByID(s->id);
+    if (idx != -1) {
+        date_indexes_drop(student_at(idx));
+        *student_at(idx) = *s;
+        date_indexes_add(s);
+        bitmap_set_slot((size_t)idx);
+        return;
+    }
+    size_t slot = next_free_slot();
+    if (slot == studentCount) {
+        ensure_capacity(studentCount + 1);
+        studentCount++;
+    } else {
+        freeSlotCount--;
+    }
+    *student_at(slot) = *s;
+    id_index_put(s->id, slot);
+    bitmap_set_slot(slot);
+    date_indexes_add(s);
+}
+
+static void remove_in_memory(size_t idx) {
+    id_index_remove(student_at(idx)->id);
+    date_indexes_drop(student_at(idx));
+    if (deleteMode == DELETE_TOMBSTONE) {
+        memset(student_at(idx), 0, sizeof(Student));
+        student_at(idx)->id = TOMBSTONE_ID;
+        bitmap_set_slot(idx);
+        free_slot_push(idx);
+        return;
+    }
+
+    if (deleteMode == DELETE_SWAP) {
+        if (idx + 1 < studentCount) {
+            *student_at(idx) = *student_at(studentCount - 1);
+            id_index_put(student_at(idx)->id, idx);
+            bitmap_set_slot(idx);
+        }
+    } else {
+        for (size_t i = idx; i + 1 < studentCount; ++i) {
+            *student_at(i) = *student_at(i+1);
+            id_index_put(student_at(i)->id, i);
+            bitmap_set_slot(i);
+        }
+    }
+    studentCount--;
+    bitmap_set_slot(studentCount);  // the vacated last slot
+    shrink_capacity();
+}
+
+// --- Journal Functions ---
+
+int saveDatabase(const char *filename);
+static int writes_settle(void);
+
+static void journal_path(const char *filename, char *out, size_t outLen) {
+    snprintf(out, outLen, "%s%s", filename, JOURNAL_SUFFIX);
+}
+
+// FNV-1a, enough to tell a complete entry from a torn one
+static uint32_t journal_checksum(uint32_t op, int32_t id, const void *payload, size_t len) {
+    uint32_t h = fnv1a(2166136261u, &op, sizeof(op));
+    h = fnv1a(h, &id, sizeof(id));
+    return payload ? fnv1a(h, payload, len) : h;
+}
+
+static void journal_close(void) {
+    if (journalFile) fclose(journalFile);
+    journalFile = NULL;
+}
+
+// Appends one entry; the record is only written for JOURNAL_PUT
+static int journal_append(const char *filename, uint32_t op, int id, const Student *s) {
+    if (!journalFile) {
+        char path[512];
+        journal_path(filename, path, sizeof(path));
+        journalFile = fopen(path, "ab");
+        if (!journalFile) {
+            perror("fopen");
+            fprintf(stderr, "Error: cannot open journal '%s'.\n", path);
+            return -1;
+        }
+        setvbuf(journalFile, NULL, _IOFBF, JOURNAL_BUFFER);
+    }
+
+    DiskRecord rec;
+    const DiskRecord *payload = NULL;
+    if (op == JOURNAL_PUT) {
+        encode_record(s, &rec);
+        payload = &rec;
+    }
+    JournalHeader h = { JOURNAL_MAGIC, op, id, journal_checksum(op, id, payload, sizeof(rec)) };
+    if (io_fwrite(&h, sizeof(h), 1, journalFile) != 1 ||
+        (payload && io_fwrite(payload, sizeof(rec), 1, journalFile) != 1)) {
+        perror("journal write");
+        journal_close();
+        return -1;
+    }
+    journalEntries++;
+    return writes_settle();
+}
+
+// Applies the journal to the loaded base records. A torn entry at the end
+// (from a crash mid-append) is cut off so later appends stay reachable.
+static int journal_replay(const char *filename) {
+    char path[512];
+    journal_path(filename, path, sizeof(path));
+    journalEntries = 0;
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        if (errno == ENOENT) return 0;
+        perror("fopen");
+        fprintf(stderr, "Error: could not open journal '%s'.\n", path);
+        return -1;
+    }
+
+    // Shift and swap deletes below would move tombstones out from under freeSlots
+    if (deleteMode != DELETE_TOMBSTONE) compact_in_memory();
+
+    long good = 0;
+    JournalHeader h;
+    Student s;
+    DiskRecord rec;
+    while (fread(&h, sizeof(h), 1, f) == 1) {
+        if (h.magic != JOURNAL_MAGIC && h.magic != JOURNAL_MAGIC_V1) break;
+        if (h.op == JOURNAL_PUT) {
+            if (h.magic == JOURNAL_MAGIC) {
+                if (fread(&rec, sizeof(rec), 1, f) != 1) break;
+                if (h.checksum != journal_checksum(h.op, h.id, &rec, sizeof(rec))) break;
+                decode_record(&rec, &s);
+            } else {
+                if (fread(&s, sizeof(s), 1, f) != 1) break;
+                if (h.checksum != journal_checksum(h.op, h.id, &s, sizeof(s))) break;
+            }
+            if (s.id != h.id) break;
+            put_in_memory(&s);
+        } else if (h.op == JOURNAL_DELETE) {
+            if (h.checksum != journal_checksum(h.op, h.id, NULL, 0)) break;
+            long idx = findStudentIndexByID(h.id);
+            if (idx != -1) remove_in_memory((size_t)idx);
+        } else {
+            break;
+        }
+        journalEntries++;
+        good = ftell(f);
+    }
+
+    int torn = !feof(f) || ferror(f) || ftell(f) != good;
+    fclose(f);
+    if (torn) {
+        fprintf(stderr, "Warning: discarding incomplete journal tail in '%s'.\n", path);
+        if (io_truncate(path, good) != 0) {
+            perror("truncate");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Folds the journal into the base file once replaying it would cost more
+// than rewriting the database, keeping each mutation O(record) amortised.
+static void journal_maybe_compact(const char *filename) {
+    if (journalEntries < JOURNAL_COMPACT_MIN || journalEntries < studentCount) return;
+    if (saveDatabase(filename) != 0) {
+        fprintf(stderr, "Warning: journal compaction failed; journal kept.\n");
+    }
+}
+
+// --- In-Place Storage Functions ---
+
+static void redo_path(const char *filename, char *out, size_t outLen) {
+    snprintf(out, outLen, "%s%s", filename, REDO_SUFFIX);
+}
+
+static void inplace_close(void) {
+    if (dataFd >= 0) close(dataFd);
+    if (redoFd >= 0) close(redoFd);
+    dataFd = -1;
+    redoFd = -1;
+}
+
+// Opens the data file and its redo log for writing at record offsets and reads
+// its header; `expected` is the record count it must hold, or -1 for any
+static int data_file_open(const char *filename, long expected) {
+    inplace_close();
+    char path[512];
+    redo_path(filename, path, sizeof(path));
+    dataFd = open(filename, O_RDWR);
+    redoFd = dataFd < 0 ? -1 : open(path, O_RDWR | O_CREAT, 0644);
+    if (dataFd < 0 || redoFd < 0) {
+        perror("open");
+        fprintf(stderr, "Error: could not open '%s' for in-place updates.\n", filename);
+        inplace_close();
+        return -1;
+    }
+    if (pread(dataFd, &dataHeader, sizeof(dataHeader), 0) != (ssize_t)sizeof(dataHeader) ||
+        !header_valid(&dataHeader) || (expected >= 0 && dataHeader.count != (size_t)expected)) {
+        fprintf(stderr, "Error: '%s' does not match the loaded records.\n", filename);
+        inplace_close();
+        return -1;
+    }
+    // Drop anything past the last record so appends land on a record boundary
+    if (io_ftruncate(dataFd, record_offset(dataHeader.count)) != 0) {
+        perror("ftruncate");
+        inplace_close();
+        return -1;
+    }
+    stagedCount = 0;
+    stagedFileCount = dataHeader.count;
+    return 0;
+}
+
+// Switches to in-place mode; the file is rewritten first unless it already matches memory
+static int inplace_open(const char *filename) {
+    if (journalEntries > 0 || baseDamaged || access(filename, F_OK) != 0) {
+        if (saveDatabase(filename) != 0) return -1;
+    }
+    if (data_file_open(filename, (long)studentCount) != 0) return -1;
+    storageMode = STORAGE_INPLACE;
+    return 0;
+}
+
+static int pwrite_full(int fd, const void *buf, size_t len, off_t off) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = io_pwrite(fd, p, len, off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("pwrite");
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+// Takes the on-disk slots [first, first + count) out of the file checksum `sum`
+static int inplace_forget(size_t first, size_t count, uint32_t *sum) {
+    DiskRecord buf[64];
+    size_t end = first + count;
+    if (end > dataHeader.count) end = dataHeader.count;
+    for (size_t i = first; i < end; ) {
+        size_t n = end - i < 64 ? end - i : 64;
+        ssize_t got = pread(dataFd, buf, n * sizeof(DiskRecord), record_offset(i));
+        if (got != (ssize_t)(n * sizeof(DiskRecord))) {
+            perror("pread");
+            return -1;
+        }
+        for (size_t k = 0; k < n; ++k) *sum -= record_checksum(&buf[k]);
+        i += n;
+    }
+    return 0;
+}
+
+// Queues `count` encoded records for slot `first` onwards; written at the next commit
+static void stage_records(const DiskRecord *recs, size_t first, size_t count) {
+    if (stagedCount + count > stagedCapacity) {
+        size_t cap = stagedCapacity ? stagedCapacity : 64;
+        while (cap < stagedCount + count) cap *= 2;
+        StagedWrite *grown = realloc(staged, cap * sizeof(StagedWrite));
+        if (!grown) {
+            perror("realloc");
+            fprintf(stderr, "Fatal: Out of memory while staging records.\n");
+            exit(EXIT_FAILURE);
+        }
+        staged = grown;
+        stagedCapacity = cap;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        StagedWrite *w = &staged[stagedCount];
+        w->slot = (uint32_t)(first + i);
+        w->seq = (uint32_t)stagedCount++;
+        w->rec = recs[i];
+    }
+    if (first + count > stagedFileCount) stagedFileCount = first + count;
+}
+
+// Encodes s for `slot`; written at the next commit
+static int inplace_put(const Student *s, size_t slot) {
+    DiskRecord rec;
+    encode_record(s, &rec);
+    stage_records(&rec, slot, 1);
+    return 0;
+}
+
+// Shortens the file to `count` records at the next commit
+static int inplace_cut(size_t count) {
+    stagedFileCount = count;
+    return 0;
+}
+
+static int staged_cmp(const void *a, const void *b) {
+    const StagedWrite *x = a, *y = b;
+    if (x->slot != y->slot) return x->slot < y->slot ? -1 : 1;
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+// Orders the staged writes by slot, keeping only the last write to each slot inside the file
+static void staged_settle(void) {
+    int sorted = 1;
+    for (size_t i = 1; i < stagedCount && sorted; ++i) sorted = staged[i].slot > staged[i - 1].slot;
+    if (!sorted) qsort(staged, stagedCount, sizeof(StagedWrite), staged_cmp);
+    size_t out = 0;
+    for (size_t i = 0; i < stagedCount; ++i) {
+        if (staged[i].slot >= stagedFileCount) continue;
+        if (out > 0 && staged[out - 1].slot == staged[i].slot) staged[out - 1] = staged[i];
+        else staged[out++] = staged[i];
+    }
+    stagedCount = out;
+}
+
+// Copies the settled writes from *pos on into `buf`, stopping at a gap in the slots;
+// returns how many were copied and stores the slot of the first in *first
+static size_t staged_next_run(size_t *pos, DiskRecord *buf, size_t max, uint32_t *first) {
+    size_t i = *pos, n = 0;
+    if (i < stagedCount) *first = staged[i].slot;
+    while (i < stagedCount && n < max && staged[i].slot == *first + n) buf[n++] = staged[i++].rec;
+    *pos = i;
+    return n;
+}
+
+// Writes and syncs the redo log for the settled writes and the header that follows them
+static int redo_write(const FileHeader *next) {
+    struct {
+        RedoRun run;
+        DiskRecord recs[ENCODE_CHUNK];
+    } chunk;
+    RedoHeader head = { REDO_MAGIC, ++redoSeq };
+    uint32_t h = fnv1a(2166136261u, &head, sizeof(head));
+    if (pwrite_full(redoFd, &head, sizeof(head), 0) != 0) return -1;
+    off_t off = sizeof(head);
+    size_t n;
+    for (size_t pos = 0; (n = staged_next_run(&pos, chunk.recs, ENCODE_CHUNK, &chunk.run.first)) > 0; ) {
+        chunk.run.count = (uint32_t)n;
+        size_t len = sizeof(RedoRun) + n * sizeof(DiskRecord);
+        h = fnv1a(h, &chunk, len);
+        if (pwrite_full(redoFd, &chunk, len, off) != 0) return -1;
+        off += (off_t)len;
+    }
+    RedoTrailer t = { { REDO_END, 0 }, *next, 0 };
+    t.checksum = fnv1a(h, &t, offsetof(RedoTrailer, checksum));
+    if (pwrite_full(redoFd, &t, sizeof(t), off) != 0) return -1;
+    if (durability != DURABILITY_NONE && io_fdatasync(redoFd) != 0) {
+        perror("fdatasync");
+        return -1;
+    }
+    return 0;
+}
+
+// Commits the staged writes: redo log, then the records, the length and the header
+static int inplace_commit(void) {
+    if (stagedCount == 0 && stagedFileCount == dataHeader.count) return 0;
+    staged_settle();
+
+    uint32_t sum = dataHeader.checksum;
+    for (size_t i = 0; i < stagedCount; ) {
+        size_t end = i;
+        while (end < stagedCount && staged[end].slot == staged[i].slot + (end - i)) {
+            sum += record_checksum(&staged[end++].rec);
+        }
+        if (inplace_forget(staged[i].slot, end - i, &sum) != 0) return -1;
+        i = end;
+    }
+    if (stagedFileCount < dataHeader.count &&
+        inplace_forget(stagedFileCount, dataHeader.count - stagedFileCount, &sum) != 0) {
+        return -1;
+    }
+    FileHeader next;
+    header_init(&next, (uint32_t)stagedFileCount, sum);
+    if (redo_write(&next) != 0) return -1;
+
+    DiskRecord buf[ENCODE_CHUNK];
+    uint32_t first;
+    size_t n;
+    for (size_t pos = 0; (n = staged_next_run(&pos, buf, ENCODE_CHUNK, &first)) > 0; ) {
+        if (pwrite_full(dataFd, buf, n * sizeof(DiskRecord), record_offset(first)) != 0) return -1;
+    }
+    if (stagedFileCount < dataHeader.count && io_ftruncate(dataFd, record_offset(stagedFileCount)) != 0) {
+        perror("ftruncate");
+        return -1;
+    }
+    if (pwrite_full(dataFd, &next, sizeof(next), 0) != 0) return -1;
+    if (durability != DURABILITY_NONE && io_fdatasync(dataFd) != 0) {
+        perror("fdatasync");
+        return -1;
+    }
+    dataHeader = next;
+    stagedCount = 0;
+    return 0;
+}
+
+// Empties the redo log before the data file is replaced, so it is never applied to the new one
+static int redo_discard(const char *filename) {
+    if (redoFd >= 0) return io_ftruncate(redoFd, 0);
+    char path[512];
+    redo_path(filename, path, sizeof(path));
+    return io_remove(path) != 0 && errno != ENOENT ? -1 : 0;
+}
+
+// Finishes an in-place commit whose redo log is complete and drops one that is not
+static int redo_recover(const char *filename) {
+    char path[512];
+    redo_path(filename, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) return 0;
+        perror("open");
+        return -1;
+    }
+    struct stat st;
+    unsigned char *log = NULL;
+    size_t len = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        len = (size_t)st.st_size;
+        log = malloc(len);
+        if (!log || read_full(fd, log, len) != 0) len = 0;
+    }
+    close(fd);
+
+    // Walk the runs up to a trailer whose checksum covers them
+    const RedoTrailer *trailer = NULL;
+    RedoHeader head = { 0, 0 };
+    if (len >= sizeof(head)) memcpy(&head, log, sizeof(head));
+    size_t off = head.magic == REDO_MAGIC ? sizeof(head) : len;
+    uint32_t h = fnv1a(2166136261u, &head, sizeof(head));
+    while (len - off >= sizeof(RedoRun)) {
+        RedoRun run;
+        memcpy(&run, log + off, sizeof(run));
+        if (run.first == REDO_END) {
+            if (len - off >= sizeof(RedoTrailer)) trailer = (const RedoTrailer *)(log + off);
+            break;
+        }
+        size_t runLen = sizeof(RedoRun) + (size_t)run.count * sizeof(DiskRecord);
+        if (run.count == 0 || run.count > ENCODE_CHUNK || len - off < runLen) break;
+        h = fnv1a(h, log + off, runLen);
+        off += runLen;
+    }
+    if (trailer && (trailer->checksum != fnv1a(h, trailer, offsetof(RedoTrailer, checksum)) ||
+                    !header_valid(&trailer->header))) {
+        trailer = NULL;
+    }
+
+    int rc = 0;
+    int data = trailer ? open(filename, O_RDWR) : -1;
+    if (trailer && data < 0 && errno == ENOENT) {
+        fprintf(stderr, "Warning: '%s' is gone; discarding its redo log '%s'.\n", filename, path);
+    } else if (trailer) {
+        int ok = data >= 0;
+        for (size_t at = sizeof(head); ok && at < off; ) {
+            RedoRun run;
+            memcpy(&run, log + at, sizeof(run));
+            size_t bytes = (size_t)run.count * sizeof(DiskRecord);
+            ok = pwrite(data, log + at + sizeof(RedoRun), bytes, record_offset(run.first)) == (ssize_t)bytes;
+            at += sizeof(RedoRun) + bytes;
+        }
+        ok = ok && ftruncate(data, record_offset(trailer->header.count)) == 0 &&
+             pwrite(data, &trailer->header, sizeof(FileHeader), 0) == (ssize_t)sizeof(FileHeader) &&
+             fdatasync(data) == 0;
+        if (data >= 0) close(data);
+        if (!ok) {
+            perror("redo");
+            fprintf(stderr, "Error: could not finish the interrupted commit logged in '%s'.\n", path);
+            rc = -1;
+        }
+    } else if (len > 0) {
+        fprintf(stderr, "Warning: discarding incomplete in-place commit in '%s'.\n", path);
+    }
+    free(log);
+    if (rc == 0 && remove(path) != 0 && errno != ENOENT) perror("remove");
+    return rc;
+}
+
+// Persists the change to a deleted slot `idx`: the hole's new content and the file length
+static int inplace_delete(size_t idx) {
+    if (deleteMode == DELETE_TOMBSTONE) {
+        if (inplace_put(student_at(idx), idx) != 0) return -1;
+        return writes_settle();
+    }
+
+    size_t moved = 0;
+    if (idx < studentCount) moved = (deleteMode == DELETE_SWAP) ? 1 : studentCount - idx;
+    for (size_t i = idx; i < idx + moved; ++i) {
+        if (inplace_put(student_at(i), i) != 0) return -1;
+    }
+    if (inplace_cut(studentCount) != 0) return -1;
+    return writes_settle();
+}
+
+// Persists one record at slot idx (idx == studentCount appends)
+static int persist_record(const char *filename, const Student *s, size_t idx) {
+    if (storageMode == STORAGE_INPLACE) {
+        if (inplace_put(s, idx) != 0) return -1;
+        return writes_settle();
+    }
+    return journal_append(filename, JOURNAL_PUT, s->id, s);
+}
+
+// --- Paged Storage ---
+// STORAGE_PAGED (-P) keeps no record in `students`. members.dat is read as
+// pages of PAGE_RECORDS records through a buffer pool of a fixed number of
+// frames, and a record is found through an on-disk open-addressing id index
+// in <datafile>.idx, paged through the same pool. Frames are reclaimed with
+// CLOCK. A dirty index page is written back when it is evicted; a dirty
+// record page is not (no steal) but is written at commit through the redo
+// log of in-place mode, so commits stay atomic. The index is only trusted
+// at open if it was checkpointed against the file's current header, and is
+// rebuilt by one scan otherwise. Deletes move the last record into the hole.
+#define PAGE_RECORDS (POOL_PAGE_SIZE / sizeof(DiskRecord))
+#define IDX_PER_PAGE (POOL_PAGE_SIZE / sizeof(IdxEntry))
+
+enum { PAGE_DATA, PAGE_INDEX, PAGE_FREE = 0xFF };
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t capacity;          // entries, a power of two; they start at page 1
+    uint32_t count;             // ids stored
+    uint32_t clean;             // 1 once checkpointed; 0 while pages may differ from the file
+    uint32_t dataCount;         // data file header it was checkpointed against
+    uint32_t dataChecksum;
+    uint32_t headerChecksum;    // FNV-1a of the fields above
+} IdxHeader;
+
+typedef struct {
+    int32_t id;
+    uint32_t slot;              // slot + 1; 0 marks an empty entry
+} IdxEntry;
+
+typedef struct {
+    uint8_t file;               // PAGE_DATA, PAGE_INDEX or PAGE_FREE
+    uint8_t ref;                // CLOCK reference bit
+    uint8_t dirty;
+    uint32_t page;
+    int next;                   // next frame in the same hash bucket, -1 ends
+} PoolFrame;
+
+static PoolFrame *poolFrames = NULL;
+static unsigned char *poolData = NULL;  // poolPages frames of POOL_PAGE_SIZE bytes
+static int *poolBuckets = NULL;
+static size_t poolPages = 0;
+static size_t poolBucketCount = 0;      // a power of two
+static size_t poolHand = 0;
+static size_t poolDirtyData = 0;
+static size_t poolHits = 0, poolMisses = 0, poolWritebacks = 0;
+static size_t pagedPoolPages = POOL_DEFAULT_PAGES;    // -P
+static int idxFd = -1;
+static IdxHeader idxHeader;
+
+int commitWrites(void);
+int loadDatabase(const char *filename);
+static void forget_database(void);
+
+static void idx_path(const char *filename, char *out, size_t outLen) {
+    snprintf(out, outLen, "%s%s", filename, IDX_SUFFIX);
+}
+
+static void idx_header_init(uint32_t capacity, uint32_t count, uint32_t clean) {
+    memset(&idxHeader, 0, sizeof(idxHeader));
+    memcpy(idxHeader.magic, IDX_MAGIC, sizeof(idxHeader.magic));
+    idxHeader.version = IDX_VERSION;
+    idxHeader.capacity = capacity;
+    idxHeader.count = count;
+    idxHeader.clean = clean;
+    idxHeader.dataCount = dataHeader.count;
+    idxHeader.dataChecksum = dataHeader.checksum;
+    idxHeader.headerChecksum = fnv1a(2166136261u, &idxHeader, offsetof(IdxHeader, headerChecksum));
+}
+
+// Rewrites the index header; once it says dirty, that is synced before any index page changes
+static int idx_write_header(uint32_t clean) {
+    idx_header_init(idxHeader.capacity, idxHeader.count, clean);
+    if (pwrite_full(idxFd, &idxHeader, sizeof(idxHeader), 0) != 0) return -1;
+    if (durability != DURABILITY_NONE && io_fdatasync(idxFd) != 0) {
+        perror("fdatasync");
+        return -1;
+    }
+    return 0;
+}
+
+static unsigned char *frame_data(size_t frame) {
+    return poolData + frame * POOL_PAGE_SIZE;
+}
+
+static size_t pool_bucket(int file, uint32_t page) {
+    return ((page * 2654435769u) ^ (uint32_t)file) & (poolBucketCount - 1);
+}
+
+static void pool_free(void) {
+    free(poolFrames);
+    free(poolData);
+    free(poolBuckets);
+    poolFrames = NULL;
+    poolData = NULL;
+    poolBuckets = NULL;
+    poolPages = poolBucketCount = poolHand = poolDirtyData = 0;
+    if (idxFd >= 0) close(idxFd);
+    idxFd = -1;
+}
+
+static void pool_init(size_t pages) {
+    pool_free();
+    poolPages = pages;
+    poolBucketCount = 16;
+    while (poolBucketCount < pages * 2) poolBucketCount <<= 1;
+    poolFrames = malloc(pages * sizeof(PoolFrame));
+    poolData = malloc(pages * POOL_PAGE_SIZE);
+    poolBuckets = malloc(poolBucketCount * sizeof(int));
+    if (!poolFrames || !poolData || !poolBuckets) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while allocating the buffer pool.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < pages; ++i) poolFrames[i] = (PoolFrame){ PAGE_FREE, 0, 0, 0, -1 };
+    for (size_t b = 0; b < poolBucketCount; ++b) poolBuckets[b] = -1;
+    poolHits = poolMisses = poolWritebacks = 0;
+}
+
+static void pool_unlink(size_t frame) {
+    PoolFrame *f = &poolFrames[frame];
+    int *link = &poolBuckets[pool_bucket(f->file, f->page)];
+    while (*link != (int)frame) link = &poolFrames[*link].next;
+    *link = f->next;
+    f->file = PAGE_FREE;
+    f->dirty = 0;
+}
+
+static off_t index_page_offset(uint32_t page) {
+    return (off_t)page * POOL_PAGE_SIZE;
+}
+
+// Writes a dirty index frame back to <datafile>.idx
+static void pool_write_back(size_t frame) {
+    PoolFrame *f = &poolFrames[frame];
+    if (pwrite_full(idxFd, frame_data(frame), POOL_PAGE_SIZE, index_page_offset(f->page)) != 0) {
+        fprintf(stderr, "Fatal: could not write id index page %u.\n", (unsigned)f->page);
+        exit(EXIT_FAILURE);
+    }
+    f->dirty = 0;
+    poolWritebacks++;
+}
+
+// CLOCK: sweep past frames with the reference bit set, clearing it, and take
+// the first without; dirty record pages wait for the commit
+static size_t pool_victim(void) {
+    for (size_t scanned = 0; scanned < 2 * poolPages; ++scanned) {
+        size_t i = poolHand;
+        PoolFrame *f = &poolFrames[i];
+        poolHand = (poolHand + 1) % poolPages;
+        if (f->file == PAGE_FREE) return i;
+        if (f->file == PAGE_DATA && f->dirty) continue;
+        if (f->ref) {
+            f->ref = 0;
+            continue;
+        }
+        if (f->dirty) pool_write_back(i);
+        pool_unlink(i);
+        return i;
+    }
+    fprintf(stderr, "Fatal: every buffer pool frame holds uncommitted records.\n");
+    exit(EXIT_FAILURE);
+}
+
+// Returns the frame holding `page` of `file`, reading it on a miss. The
+// pointer is only good until the next pool_page call. `write` marks it dirty.
+static unsigned char *pool_page(int file, uint32_t page, int write) {
+    size_t b = pool_bucket(file, page);
+    int i = poolBuckets[b];
+    while (i != -1 && (poolFrames[i].file != file || poolFrames[i].page != page)) i = poolFrames[i].next;
+    if (i != -1) {
+        poolHits++;
+    } else {
+        poolMisses++;
+        i = (int)pool_victim();
+        unsigned char *data = frame_data((size_t)i);
+        memset(data, 0, POOL_PAGE_SIZE);
+        // Pages past the end of either file read as zeros: empty slots and empty index entries
+        ssize_t got;
+        if (file == PAGE_DATA) {
+            size_t first = (size_t)page * PAGE_RECORDS;
+            size_t n = first < dataHeader.count ? dataHeader.count - first : 0;
+            if (n > PAGE_RECORDS) n = PAGE_RECORDS;
+            got = n ? pread(dataFd, data, n * sizeof(DiskRecord), record_offset(first)) : 0;
+        } else {
+            got = pread(idxFd, data, POOL_PAGE_SIZE, index_page_offset(page));
+        }
+        if (got < 0) {
+            perror("pread");
+            fprintf(stderr, "Fatal: could not read page %u of the %s.\n", (unsigned)page,
+                    file == PAGE_DATA ? "database" : "id index");
+            exit(EXIT_FAILURE);
+        }
+        poolFrames[i] = (PoolFrame){ (uint8_t)file, 0, 0, page, poolBuckets[b] };
+        poolBuckets[b] = i;
+    }
+    PoolFrame *f = &poolFrames[i];
+    f->ref = 1;
+    if (write && !f->dirty) {
+        if (file == PAGE_INDEX && idxHeader.clean && idx_write_header(0) != 0) {
+            fprintf(stderr, "Fatal: could not mark the id index as in use.\n");
+            exit(EXIT_FAILURE);
+        }
+        f->dirty = 1;
+        if (file == PAGE_DATA) poolDirtyData++;
+    }
+    return frame_data((size_t)i);
+}
+
+// Forgets every cached page of `file` without writing it back
+static void pool_drop(int file) {
+    for (size_t i = 0; i < poolPages; ++i) {
+        if (poolFrames[i].file != file) continue;
+        if (file == PAGE_DATA && poolFrames[i].dirty) poolDirtyData--;
+        pool_unlink(i);
+    }
+}
+
+static DiskRecord *paged_record(size_t slot, int write) {
+    return (DiskRecord *)pool_page(PAGE_DATA, (uint32_t)(slot / PAGE_RECORDS), write) + slot % PAGE_RECORDS;
+}
+
+static IdxEntry *idx_entry(size_t pos, int write) {
+    return (IdxEntry *)pool_page(PAGE_INDEX, (uint32_t)(1 + pos / IDX_PER_PAGE), write) + pos % IDX_PER_PAGE;
+}
+
+// Position holding id, or the empty position where it would go
+static size_t idx_probe(int id) {
+    size_t mask = idxHeader.capacity - 1;
+    size_t pos = id_hash(id) & mask;
+    for (;;) {
+        IdxEntry e = *idx_entry(pos, 0);
+        if (e.slot == 0 || e.id == id) return pos;
+        pos = (pos + 1) & mask;
+    }
+}
+
+static long idx_find(int id) {
+    IdxEntry e = *idx_entry(idx_probe(id), 0);
+    return e.slot ? (long)e.slot - 1 : -1;
+}
+
+static void idx_insert(int id, size_t slot) {
+    size_t pos = idx_probe(id);
+    IdxEntry *e = idx_entry(pos, 1);
+    if (e->slot == 0) idxHeader.count++;
+    e->id = id;
+    e->slot = (uint32_t)slot + 1;
+}
+
+// Empties the index at `capacity` entries and fills it with one scan of the records
+static int idx_rebuild(uint32_t capacity) {
+    pool_drop(PAGE_INDEX);
+    off_t size = index_page_offset((uint32_t)(1 + (capacity + IDX_PER_PAGE - 1) / IDX_PER_PAGE));
+    if (io_ftruncate(idxFd, 0) != 0 || io_ftruncate(idxFd, size) != 0) {
+        perror("ftruncate");
+        return -1;
+    }
+    idx_header_init(capacity, 0, 1);
+    if (idx_write_header(0) != 0) return -1;
+    for (size_t slot = 0; slot < pagedCount; ++slot) {
+        int id = paged_record(slot, 0)->id;
+        if (id != TOMBSTONE_ID) idx_insert(id, slot);
+    }
+    pagedLive = idxHeader.count;
+    return 0;
+}
+
+// Records that `id` lives at `slot`, doubling the index first if it would pass 70% full
+static int idx_put(int id, size_t slot) {
+    if ((idxHeader.count + 1) * 10 > (size_t)idxHeader.capacity * 7 && idx_rebuild(idxHeader.capacity * 2) != 0) {
+        return -1;
+    }
+    idx_insert(id, slot);
+    return 0;
+}
+
+// Removes id, shifting later entries of the probe run back as id_index_remove does
+static void idx_remove(int id) {
+    size_t mask = idxHeader.capacity - 1;
+    size_t hole = idx_probe(id);
+    if (idx_entry(hole, 0)->slot == 0) return;
+
+    size_t pos = hole;
+    for (;;) {
+        pos = (pos + 1) & mask;
+        IdxEntry e = *idx_entry(pos, 0);
+        if (e.slot == 0) break;
+        size_t home = id_hash(e.id) & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            *idx_entry(hole, 1) = e;
+            hole = pos;
+        }
+    }
+    idx_entry(hole, 1)->slot = 0;
+    idxHeader.count--;
+}
+
+// Stages every dirty record page and commits them as one in-place commit
+static int paged_commit(void) {
+    for (size_t i = 0; i < poolPages; ++i) {
+        PoolFrame *f = &poolFrames[i];
+        if (f->file != PAGE_DATA || !f->dirty) continue;
+        size_t first = (size_t)f->page * PAGE_RECORDS;
+        if (first < pagedCount) {
+            size_t n = pagedCount - first < PAGE_RECORDS ? pagedCount - first : PAGE_RECORDS;
+            stage_records((const DiskRecord *)frame_data(i), first, n);
+        }
+        f->dirty = 0;
+    }
+    poolDirtyData = 0;
+    stagedFileCount = pagedCount;
+    return inplace_commit();
+}
+
+// Commits, writes back the index and marks it as matching the file
+static int paged_checkpoint(void) {
+    pendingWrites = 0;
+    if (paged_commit() != 0) return -1;
+    if (idxHeader.clean && idxHeader.dataCount == dataHeader.count && idxHeader.dataChecksum == dataHeader.checksum) {
+        return 0;
+    }
+    for (size_t i = 0; i < poolPages; ++i) {
+        if (poolFrames[i].file == PAGE_INDEX && poolFrames[i].dirty) pool_write_back(i);
+    }
+    if (durability != DURABILITY_NONE && io_fdatasync(idxFd) != 0) {
+        perror("fdatasync");
+        return -1;
+    }
+    return idx_write_header(1);
+}
+
+// Called after each paged mutation: the usual commit policy, plus a commit
+// whenever uncommitted record pages fill half the pool
+static int paged_settle(void) {
+    int rc = writes_settle();
+    if (rc == 0 && poolDirtyData * 2 > poolPages) rc = commitWrites();
+    return rc;
+}
+
+// Opens members.dat for paged access with a pool of `pages` frames. A
+// journal or a legacy file is folded into a version 2 file first, which
+// is the one time the records are loaded into memory.
+static int paged_open(const char *filename, size_t pages) {
+    if (redo_recover(filename) != 0) return -1;
+    char path[512];
+    journal_path(filename, path, sizeof(path));
+    struct stat st;
+    int fold = access(filename, F_OK) != 0 || (stat(path, &st) == 0 && st.st_size > 0);
+    FileHeader header;
+    FILE *f = fopen(filename, "rb");
+    if (f) {
+        fold |= fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, DB_MAGIC, sizeof(header.magic)) != 0;
+        fclose(f);
+    }
+    if (fold) {
+        int rc = loadDatabase(filename) == 0 && saveDatabase(filename) == 0 ? 0 : -1;
+        journal_close();
+        forget_database();
+        if (rc != 0) return -1;
+    }
+
+    if (data_file_open(filename, -1) != 0) return -1;
+    pagedCount = dataHeader.count;
+    pool_init(pages);
+    idx_path(filename, path, sizeof(path));
+    idxFd = open(path, O_RDWR | O_CREAT, 0644);
+    if (idxFd < 0) {
+        perror("open");
+        fprintf(stderr, "Error: could not open id index '%s'.\n", path);
+        pool_free();
+        inplace_close();
+        return -1;
+    }
+
+    IdxHeader h;
+    int usable = pread(idxFd, &h, sizeof(h), 0) == (ssize_t)sizeof(h) && fstat(idxFd, &st) == 0 &&
+                 memcmp(h.magic, IDX_MAGIC, sizeof(h.magic)) == 0 && h.version == IDX_VERSION &&
+                 h.headerChecksum == fnv1a(2166136261u, &h, offsetof(IdxHeader, headerChecksum)) &&
+                 h.clean == 1 && h.dataCount == dataHeader.count && h.dataChecksum == dataHeader.checksum &&
+                 h.capacity >= ID_INDEX_MIN_CAPACITY && (h.capacity & (h.capacity - 1)) == 0 &&
+                 (size_t)h.count * 10 <= (size_t)h.capacity * 7 &&
+                 st.st_size >= index_page_offset((uint32_t)(1 + (h.capacity + IDX_PER_PAGE - 1) / IDX_PER_PAGE));
+    storageMode = STORAGE_PAGED;
+    if (usable) {
+        idxHeader = h;
+        pagedLive = h.count;
+        return 0;
+    }
+
+    uint32_t capacity = ID_INDEX_MIN_CAPACITY;
+    while (capacity < pagedCount * 2) capacity <<= 1;
+    if (pagedCount > 0) printf("Rebuilding id index '%s' from %zu records.\n", path, pagedCount);
+    if (idx_rebuild(capacity) != 0 || paged_checkpoint() != 0) {
+        fprintf(stderr, "Error: could not build id index '%s'.\n", path);
+        pool_free();
+        inplace_close();
+        storageMode = STORAGE_JOURNAL;
+        return -1;
+    }
+    return 0;
+}
+
+// Checkpoints and releases the pool; the index is then trusted at the next open
+static int paged_close(void) {
+    if (storageMode != STORAGE_PAGED) return 0;
+    int rc = paged_checkpoint();
+    printf("Buffer pool: %zu hits, %zu misses, %zu index pages written back.\n", poolHits, poolMisses, poolWritebacks);
+    pool_free();
+    inplace_close();
+    storageMode = STORAGE_JOURNAL;
+    return rc;
+}
+
+static int paged_get(int id, Student *out) {
+    long slot = idx_find(id);
+    if (slot < 0) return DB_ERR_NOT_FOUND;
+    if (out) decode_record(paged_record((size_t)slot, 0), out);
+    return DB_OK;
+}
+
+static int paged_add(const Student *s) {
+    if (idx_find(s->id) != -1) return DB_ERR_EXISTS;
+    size_t slot = pagedCount++;
+    encode_record(s, paged_record(slot, 1));
+    if (idx_put(s->id, slot) != 0) return DB_ERR_IO;
+    pagedLive = idxHeader.count;
+    return paged_settle() == 0 ? DB_OK : DB_ERR_IO;
+}
+
+static int paged_update(int id, const char *batch, const char *membership) {
+    long slot = idx_find(id);
+    if (slot < 0) return DB_ERR_NOT_FOUND;
+    DiskRecord *r = paged_record((size_t)slot, 1);
+    if (batch && *batch) r->batch = enum_code(batchNames, NAME_COUNT(batchNames), batch);
+    if (membership && *membership) r->membership = enum_code(membershipNames, NAME_COUNT(membershipNames), membership);
+    return paged_settle() == 0 ? DB_OK : DB_ERR_IO;
+}
+
+static int paged_delete(int id) {
+    long slot = idx_find(id);
+    if (slot < 0) return DB_ERR_NOT_FOUND;
+    size_t last = pagedCount - 1;
+    idx_remove(id);
+    if ((size_t)slot != last) {
+        DiskRecord moved = *paged_record(last, 0);
+        *paged_record((size_t)slot, 1) = moved;
+        if (moved.id != TOMBSTONE_ID) idx_insert(moved.id, (size_t)slot);
+    }
+    pagedCount--;
+    pagedLive = idxHeader.count;
+    return paged_settle() == 0 ? DB_OK : DB_ERR_IO;
+}
+
+// --- Group Commit ---
+
+// Pushes every pending write to the OS and, unless durability is NONE, to disk
+int commitWrites(void) {
+    if (pendingWrites == 0) return 0;
+    pendingWrites = 0;
+    if (storageMode == STORAGE_INPLACE) return dataFd >= 0 ? inplace_commit() : 0;
+    if (storageMode == STORAGE_PAGED) return paged_commit();
+    if (!journalFile) return 0;
+    if (io_fflush(journalFile) != 0 ||
+        (durability != DURABILITY_NONE && io_fdatasync(fileno(journalFile)) != 0)) {
+        perror("journal commit");
+        return -1;
+    }
+    return 0;
+}
+
+static long elapsed_ms(const struct timespec *since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)(now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+// Called after each logged or written mutation; commits when the level,
+// the pending count or the commit window says so
+static int writes_settle(void) {
+    if (pendingWrites++ == 0) clock_gettime(CLOCK_MONOTONIC, &firstPendingAt);
+    if (durability == DURABILITY_SYNC || pendingWrites >= GROUP_COMMIT_MAX) return commitWrites();
+    if (elapsed_ms(&firstPendingAt) >= commitWindowMs) return commitWrites();
+    return 0;
+}
+
+// Batches nest; writes inside one are committed together when the outermost ends
+void beginBatch(void) {
+    batchDepth++;
+}
+
+int commitBatch(void) {
+    if (batchDepth > 0) batchDepth--;
+    if (batchDepth > 0) return 0;
+    date_indexes_settle();
+    return commitWrites();
+}
+
+// Removes tombstones; in place the file is rewritten too so offsets stay in step
+static int tombstone_compact(const char *filename) {
+    if (storageMode == STORAGE_INPLACE) return saveDatabase(filename);
+    compact_in_memory();
+    return 0;
+}
+
+static void tombstone_maybe_compact(const char *filename) {
+    if (freeSlotCount < TOMBSTONE_COMPACT_MIN) return;
+    if (freeSlotCount * TOMBSTONE_COMPACT_RATIO < studentCount) return;
+    if (tombstone_compact(filename) != 0) {
+        fprintf(stderr, "Warning: tombstone compaction failed.\n");
+    }
+}
+
+// --- Core Logic Functions ---
+
+static void printStudent(const Student *s) {
+    if (!s) return;
+    printf("\nID: %d\nName: %s\nBatch: %s\nMembership: %s\nRegDate: %s\nDOB: %s\nInterest: %s\n",
+           s->id, s->name, s->batch, s->membership, s->regDate, s->dob, s->interest);
+}
+
+// --- Parallel Load ---
+// A v2 file is mapped (or read in large chunks) and split into ranges of
+// whole 64-slot bitmap words. Each thread checksums and decodes its range
+// straight into the preallocated array, sets its own bitmap words and
+// collects a sorted run of date entries. Meanwhile the calling thread builds
+// the id index and free-slot stack from the raw ids, which need no decoding.
+// The date runs are merged last.
+typedef struct {
+    const DiskRecord *recs;     // every record in the file
+    size_t begin, end;          // slots this part decodes
+    uint32_t sum;               // record checksums over the part
+    DateEntry *regDates, *dobs; // this part's runs start at offset `begin`
+    size_t regDateCount, dobCount;
+} LoadPart;
+
+static void *load_part_main(void *arg) {
+    LoadPart *p = arg;
+    DateEntry *regDates = p->regDates + p->begin, *dobs = p->dobs + p->begin;
+    for (size_t i = p->begin; i < p->end; ++i) {
+        const DiskRecord *r = &p->recs[i];
+        Student *s = student_at(i);
+        p->sum += record_checksum(r);
+        decode_record(r, s);
+        if (is_tombstone(s)) continue;
+
+        uint64_t bit = 1ull << (i % 64);
+        if (r->batch < NAME_COUNT(batchNames)) batchBits[r->batch][i / 64] |= bit;
+        if (r->membership < NAME_COUNT(membershipNames)) membershipBits[r->membership][i / 64] |= bit;
+        if (r->interest < NAME_COUNT(interestNames)) interestBits[r->interest][i / 64] |= bit;
+
+        DateEntry e = { pack_date(s->regDate), s->id, 0 };
+        if (e.key) regDates[p->regDateCount++] = e;
+        e.key = pack_date(s->dob);
+        if (e.key) dobs[p->dobCount++] = e;
+    }
+    qsort(regDates, p->regDateCount, sizeof(DateEntry), date_entry_cmp);
+    qsort(dobs, p->dobCount, sizeof(DateEntry), date_entry_cmp);
+    return NULL;
+}
+
+// Replaces ix with the merge of the parts' sorted runs; takes ownership of `entries`
+static void date_index_adopt_runs(DateIndex *ix, DateEntry *entries, const LoadPart *parts, size_t partCount,
+                                  int dob) {
+    size_t total = 0, head[LOAD_MAX_THREADS];
+    for (size_t k = 0; k < partCount; ++k) {
+        head[k] = 0;
+        total += dob ? parts[k].dobCount : parts[k].regDateCount;
+    }
+    date_index_free(ix);
+    ix->sorted = malloc((total ? total : 1) * sizeof(DateEntry));
+    if (!ix->sorted) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while building a date index.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t out = 0; out < total; ++out) {
+        const DateEntry *best = NULL;
+        size_t bestPart = 0;
+        for (size_t k = 0; k < partCount; ++k) {
+            if (head[k] == (dob ? parts[k].dobCount : parts[k].regDateCount)) continue;
+            const DateEntry *e = &entries[parts[k].begin + head[k]];
+            if (!best || date_entry_cmp(e, best) < 0) {
+                best = e;
+                bestPart = k;
+            }
+        }
+        ix->sorted[out] = *best;
+        head[bestPart]++;
+    }
+    ix->sortedCount = total;
+    free(entries);
+}
+
+// Loads `count` records that follow the header of the open v2 file; returns
+// how many were present and stores their checksum sum in *sumOut
+static size_t load_records(FILE *f, size_t count, uint32_t *sumOut) {
+    struct stat st;
+    size_t present = 0;
+    if (fstat(fileno(f), &st) == 0 && (size_t)st.st_size > sizeof(FileHeader)) {
+        present = ((size_t)st.st_size - sizeof(FileHeader)) / sizeof(DiskRecord);
+    }
+    if (present > count) present = count;
+    ensure_capacity(count);
+
+    // Map the file when possible; otherwise read it in large chunks
+    const DiskRecord *recs = NULL;
+    void *map = MAP_FAILED;
+    DiskRecord *copy = NULL;
+    size_t mapLength = sizeof(FileHeader) + present * sizeof(DiskRecord);
+    if (present > 0) {
+        map = mmap(NULL, mapLength, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+        if (map != MAP_FAILED) {
+            posix_madvise(map, mapLength, POSIX_MADV_SEQUENTIAL);
+            recs = (const DiskRecord *)((const char *)map + sizeof(FileHeader));
+        } else {
+            copy = malloc(present * sizeof(DiskRecord));
+            if (!copy) {
+                perror("malloc");
+                fprintf(stderr, "Fatal: Out of memory while loading records.\n");
+                exit(EXIT_FAILURE);
+            }
+            size_t got = 0;
+            while (got < present) {
+                size_t n = present - got < LOAD_CHUNK_RECORDS ? present - got : LOAD_CHUNK_RECORDS;
+                size_t r = fread(copy + got, sizeof(DiskRecord), n, f);
+                got += r;
+                if (r < n) break;
+            }
+            present = got;
+            recs = copy;
+        }
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = present / LOAD_PARALLEL_MIN;
+    if (threads > (size_t)(cpus > 0 ? cpus : 1)) threads = (size_t)(cpus > 0 ? cpus : 1);
+    if (threads > LOAD_MAX_THREADS) threads = LOAD_MAX_THREADS;
+    if (threads == 0) threads = 1;
+    size_t per = ((present + threads - 1) / threads + 63) / 64 * 64;
+
+    bitmap_clear(present);
+    DateEntry *regDates = malloc((present ? present : 1) * sizeof(DateEntry));
+    DateEntry *dobs = malloc((present ? present : 1) * sizeof(DateEntry));
+    if (!regDates || !dobs) {
+        perror("malloc");
+        fprintf(stderr, "Fatal: Out of memory while building date indexes.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LoadPart parts[LOAD_MAX_THREADS];
+    pthread_t tids[LOAD_MAX_THREADS];
+    int started[LOAD_MAX_THREADS];
+    for (size_t k = 0; k < threads; ++k) {
+        LoadPart p = { recs, k * per < present ? k * per : present, (k + 1) * per < present ? (k + 1) * per : present,
+                       0, regDates, dobs, 0, 0 };
+        parts[k] = p;
+        // Part 0 runs on this thread once the id index is built
+        started[k] = k > 0 && pthread_create(&tids[k], NULL, load_part_main, &parts[k]) == 0;
+    }
+
+    size_t capacity = ID_INDEX_MIN_CAPACITY;
+    while (capacity < present * 2) capacity <<= 1;
+    id_index_alloc(capacity);
+    for (size_t i = 0; i < present; ++i) {
+        // In-place files keep their tombstones so slots still match offsets
+        if (recs[i].id == TOMBSTONE_ID) free_slot_push(i);
+        else id_index_put(recs[i].id, i);
+    }
+
+    uint32_t sum = 0;
+    for (size_t k = 0; k < threads; ++k) {
+        if (started[k]) pthread_join(tids[k], NULL);
+        else load_part_main(&parts[k]);
+        sum += parts[k].sum;
+    }
+    studentCount = present;
+    date_index_adopt_runs(&regDateIndex, regDates, parts, threads, 0);
+    date_index_adopt_runs(&dobIndex, dobs, parts, threads, 1);
+
+    if (map != MAP_FAILED) munmap(map, mapLength);
+    free(copy);
+    *sumOut = sum;
+    return present;
+}
+
+int loadDatabase(const char *filename) {
+    journal_close();
+    if (redo_recover(filename) != 0) return -1;
+    legacyHeld = 0;
+    FILE *f = fopen(filename, "rb");
+    if (!f) {
+        if (errno == ENOENT) {
+            studentCount = 0;
+            freeSlotCount = 0;
+            indexes_rebuild();
+            date_index_rebuild(&regDateIndex, offsetof(Student, regDate));
+            date_index_rebuild(&dobIndex, offsetof(Student, dob));
+            return journal_replay(filename);
+        }
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for reading.\n", filename);
+        return -1;
+    }
+
+    studentCount = 0;
+    freeSlotCount = 0;
+    baseDamaged = 0;
+
+    FileHeader header;
+    size_t lossy = 0;               // legacy records the conversion would change
+    int legacy = fread(&header, sizeof(header), 1, f) != 1 ||
+                 memcmp(header.magic, DB_MAGIC, sizeof(header.magic)) != 0;
+    if (legacy) {
+        // Original format: a bare array of Student structs
+        struct stat st;
+        if (fstat(fileno(f), &st) == 0) ensure_capacity((size_t)st.st_size / sizeof(Student) + 1);
+        rewind(f);
+        size_t want, n;
+        do {
+            ensure_capacity(studentCount + 1);
+            Student *run = student_run(studentCount, studentCapacity, &want);
+            n = fread(run, sizeof(Student), want, f);
+            studentCount += n;
+        } while (n == want);
+        for (size_t i = 0; i < studentCount; ++i) {
+            const char *why = encode_loss(student_at(i));
+            if (!why) continue;
+            if (lossy++ < LEGACY_ERRORS_SHOWN) {
+                fprintf(stderr, "Warning: record %zu (id %d) in '%s': %s; version %d cannot store it as is.\n",
+                        i + 1, student_at(i)->id, filename, why, DB_VERSION);
+            }
+        }
+        indexes_rebuild();
+        date_index_rebuild(&regDateIndex, offsetof(Student, regDate));
+        date_index_rebuild(&dobIndex, offsetof(Student, dob));
+    } else {
+        if (!header_valid(&header)) {
+            fprintf(stderr, "Error: '%s' has a damaged header or unsupported format version %u.\n",
+                    filename, (unsigned)header.version);
+            fclose(f);
+            return -1;
+        }
+        uint32_t sum = 0;
+        load_records(f, header.count, &sum);
+        if (studentCount != header.count) {
+            fprintf(stderr, "Warning: '%s' is truncated: header lists %u records, found %zu.\n",
+                    filename, (unsigned)header.count, studentCount);
+            baseDamaged = 1;
+        } else if (sum != header.checksum) {
+            fprintf(stderr, "Warning: checksum mismatch in '%s'; a record may be damaged.\n", filename);
+            baseDamaged = 1;
+        }
+    }
+
+    if (ferror(f)) {
+        perror("fread");
+        fclose(f);
+        return -1;
+    }
+
+    if (fclose(f) != 0) {
+        perror("fclose");
+        return -1;
+    }
+    if (journal_replay(filename) != 0) return -1;
+
+    if (legacy) {
+        // The old file stays behind under another name rather than being lost;
+        // if that fails it is left unconverted and saves are refused, so
+        // changes stay in the journal
+        if (lossy > 0) {
+            char keep[512];
+            snprintf(keep, sizeof(keep), "%s%s", filename, LEGACY_SUFFIX);
+            if (link(filename, keep) != 0) {
+                perror("link");
+                fprintf(stderr, "Warning: %zu record(s) in '%s' would change on conversion and it could not be "
+                        "kept as '%s'; it will not be saved over.\n", lossy, filename, keep);
+                legacyHeld = 1;
+                return 0;
+            }
+            fprintf(stderr, "Warning: %zu record(s) change on conversion; the original file is kept as '%s'.\n",
+                    lossy, keep);
+        }
+        printf("Converting '%s' to record format version %d.\n", filename, DB_VERSION);
+        return saveDatabase(filename);
+    }
+    return 0;
+}
+
+// Writes the full database without tombstones and, once it is in place, drops the journal it supersedes
+int saveDatabase(const char *filename) {
+    // Paged, the file already is the database; saving means a checkpoint
+    if (storageMode == STORAGE_PAGED) return paged_checkpoint();
+    if (legacyHeld) {
+        fprintf(stderr, "Error: not saving over '%s': its original records could not be kept aside.\n", filename);
+        return -1;
+    }
+
+    compact_in_memory();
+
+    char tmpName[512];
+    snprintf(tmpName, sizeof(tmpName), "%s.tmp", filename);
+
+    FILE *f = fopen(tmpName, "wb");
+    if (!f) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open temporary file for writing.\n");
+        return -1;
+    }
+
+    // Header goes last, once the record checksum is known
+    FileHeader header;
+    header_init(&header, 0, 0);
+    int ok = io_fwrite(&header, sizeof(header), 1, f) == 1;
+
+    DiskRecord buf[ENCODE_CHUNK];
+    uint32_t sum = 0;
+    for (size_t i = 0; ok && i < studentCount; ) {
+        size_t n;
+        const Student *run = student_run(i, i + ENCODE_CHUNK < studentCount ? i + ENCODE_CHUNK : studentCount, &n);
+        for (size_t k = 0; k < n; ++k) {
+            encode_record(&run[k], &buf[k]);
+            sum += record_checksum(&buf[k]);
+        }
+        ok = io_fwrite(buf, sizeof(DiskRecord), n, f) == n;
+        i += n;
+    }
+    header_init(&header, (uint32_t)studentCount, sum);
+    ok = ok && io_fflush(f) == 0 && fseek(f, 0, SEEK_SET) == 0 && io_fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!ok) {
+        perror("fwrite");
+        fclose(f);
+        remove(tmpName);
+        return -1;
+    }
+
+    if (io_fflush(f) != 0) { perror("fflush"); fclose(f); remove(tmpName); return -1; }
+    if (durability != DURABILITY_NONE && io_fsync(fileno(f)) != 0) { perror("fsync"); fclose(f); remove(tmpName); return -1; }
+    if (fclose(f) != 0) { perror("fclose"); remove(tmpName); return -1; }
+
+    // rename replaces the old file atomically, so a crash leaves one whole version
+    if (redo_discard(filename) != 0) {
+        perror("redo");
+        remove(tmpName);
+        return -1;
+    }
+    if (io_rename(tmpName, filename) != 0) {
+        perror("rename");
+        fprintf(stderr, "Error: could not replace database file.\n");
+        remove(tmpName);
+        return -1;
+    }
+    if (durability != DURABILITY_NONE && sync_parent_dir(filename) != 0) perror("fsync");
+
+    // Until this removal a crash replays the old journal over the new file,
+    // which already holds its effects; every entry is an upsert or delete by id
+    char path[512];
+    journal_path(filename, path, sizeof(path));
+    journal_close();
+    if (io_remove(path) != 0 && errno != ENOENT) perror("remove");
+    journalEntries = 0;
+    baseDamaged = 0;
+    pendingWrites = 0;
+    stagedCount = 0;    // already part of the file just written
+    stagedFileCount = studentCount;
+
+    // The rename replaced the file under the in-place descriptor
+    if (storageMode == STORAGE_INPLACE && dataFd >= 0) {
+        close(dataFd);
+        dataFd = open(filename, O_RDWR);
+        if (dataFd < 0) {
+            perror("open");
+            return -1;
+        }
+        dataHeader = header;
+    }
+    return 0;
+}
+
+// The db_* functions apply one mutation to DATAFILE without printing, for
+// callers that report errors their own way (the menu, the server)
+int db_add(const Student *s) {
+    if (s->id == TOMBSTONE_ID) return DB_ERR_INVALID;
+    if (storageMode == STORAGE_PAGED) return paged_add(s);
+    if (findStudentIndexByID(s->id) != -1) return DB_ERR_EXISTS;
+
+    // Add to file or journal (for persistence)
+    if (persist_record(DATAFILE, s, next_free_slot()) != 0) return DB_ERR_IO;
+
+    // Add to in-memory array
+    put_in_memory(s);
+    journal_maybe_compact(DATAFILE);
+    return DB_OK;
+}
+
+// Changes batch and/or membership; NULL or "" keeps the current value
+int db_update(int studentID, const char *batch, const char *membership) {
+    long idx = storageMode == STORAGE_PAGED ? idx_find(studentID) : findStudentIndexByID(studentID);
+    if (idx == -1) return DB_ERR_NOT_FOUND;
+    if ((batch && *batch && !validBatch(batch)) || (membership && *membership && !validMembership(membership))) {
+        return DB_ERR_INVALID;
+    }
+    if (storageMode == STORAGE_PAGED) return paged_update(studentID, batch, membership);
+
+    Student updated = *student_at(idx);
+    if (batch && *batch) {
+        strncpy(updated.batch, batch, sizeof(updated.batch)-1);
+        updated.batch[sizeof(updated.batch)-1] = '\0';
+    }
+    if (membership && *membership) {
+        strncpy(updated.membership, membership, sizeof(updated.membership)-1);
+        updated.membership[sizeof(updated.membership)-1] = '\0';
+    }
+
+    if (persist_record(DATAFILE, &updated, (size_t)idx) != 0) return DB_ERR_IO;
+    *student_at(idx) = updated;
+    bitmap_set_slot((size_t)idx);
+    journal_maybe_compact(DATAFILE);
+    return DB_OK;
+}
+
+int db_delete(int studentID) {
+    if (storageMode == STORAGE_PAGED) return paged_delete(studentID);
+    long idx = findStudentIndexByID(studentID);
+    if (idx == -1) return DB_ERR_NOT_FOUND;
+
+    if (storageMode == STORAGE_JOURNAL &&
+        journal_append(DATAFILE, JOURNAL_DELETE, studentID, NULL) != 0) {
+        return DB_ERR_IO;
+    }
+    remove_in_memory((size_t)idx);
+    journal_maybe_compact(DATAFILE);
+
+    // In place, only the slots the delete touched and the file length change
+    if (storageMode == STORAGE_INPLACE && inplace_delete((size_t)idx) != 0) return DB_ERR_IO;
+    tombstone_maybe_compact(DATAFILE);
+    return DB_OK;
+}
+
+// Copies the record with this id into *out (if out is not NULL)
+int db_get(int studentID, Student *out) {
+    if (storageMode == STORAGE_PAGED) return paged_get(studentID, out);
+    long idx = findStudentIndexByID(studentID);
+    if (idx == -1) return DB_ERR_NOT_FOUND;
+    if (out) *out = *student_at(idx);
+    return DB_OK;
+}
+
+// The batch forms run their items inside one beginBatch / commitBatch
+static long batch_done(long ok) {
+    return commitBatch() == 0 ? ok : -1;
+}
+
+long db_add_batch(const Student *recs, int *results, size_t count) {
+    long ok = 0;
+    beginBatch();
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = db_add(&recs[i]);
+        ok += results[i] == DB_OK;
+    }
+    return batch_done(ok);
+}
+
+long db_update_batch(const StudentUpdate *updates, int *results, size_t count) {
+    long ok = 0;
+    beginBatch();
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = db_update(updates[i].id, updates[i].batch, updates[i].membership);
+        ok += results[i] == DB_OK;
+    }
+    return batch_done(ok);
+}
+
+long db_delete_batch(const int *ids, int *results, size_t count) {
+    long ok = 0;
+    beginBatch();
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = db_delete(ids[i]);
+        ok += results[i] == DB_OK;
+    }
+    return batch_done(ok);
+}
+
+long db_get_batch(const int *ids, Student *out, int *results, size_t count) {
+    long ok = 0;
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = db_get(ids[i], &out[i]);
+        ok += results[i] == DB_OK;
+    }
+    return ok;
+}
+
+// Walks the live records in slot order:
+//     StudentCursor c = { 0 };
+//     for (const Student *s; (s = student_next(&c)); ) ...
+typedef struct {
+    size_t slot;                // next slot to look at
+    Student decoded;            // paged mode decodes here; valid until the next call
+} StudentCursor;
+
+static const Student *student_next(StudentCursor *c) {
+    if (storageMode == STORAGE_PAGED) {
+        while (c->slot < pagedCount) {
+            const DiskRecord *r = paged_record(c->slot++, 0);
+            if (r->id == TOMBSTONE_ID) continue;
+            decode_record(r, &c->decoded);
+            return &c->decoded;
+        }
+        return NULL;
+    }
+    while (c->slot < studentCount) {
+        const Student *s = student_at(c->slot++);
+        if (!is_tombstone(s)) return s;
+    }
+    return NULL;
+}
+
+
+int addStudent(const Student *s) {
+    if (!s) return -1;
+
+    int rc = db_add(s);
+    if (rc == DB_ERR_INVALID) {
+        fprintf(stderr, "Error: Student ID %d is reserved. Registration failed.\n", s->id);
+    } else if (rc == DB_ERR_EXISTS) {
+        fprintf(stderr, "Error: Student ID %d already exists. Registration failed.\n", s->id);
+    } else if (rc == DB_ERR_IO) {
+        fprintf(stderr, "Error: cannot write new student to disk.\n");
+    }
+    return rc == DB_OK ? 0 : -1;
+}
+
+int updateStudent(int studentID) {
+    Student current;
+    if (db_get(studentID, &current) != DB_OK) {
+        fprintf(stderr, "Student ID %d not found.\n", studentID);
+        return -1;
+    }
+
+    char batch[128], membership[128];
+
+    printf("Current record:\n");
+    printStudent(&current);
+
+    // Clear buffer after previous scanf (if any)
+    int c; while ((c = getchar()) != '\n' && c != EOF); 
+    
+    read_line_input("Enter new batch (CS / SE / Cyber Security / AI) or press Enter to keep: ", batch, sizeof(batch));
+    if (strlen(batch) > 0 && !validBatch(batch)) {
+        fprintf(stderr, "Invalid batch string. Update aborted.\n");
+        return -1;
+    }
+
+    read_line_input("Enter new membership (IEEE / ACM) or press Enter to keep: ", membership, sizeof(membership));
+    if (strlen(membership) > 0 && !validMembership(membership)) {
+        fprintf(stderr, "Invalid membership. Update aborted.\n");
+        return -1;
+    }
+    
+    if (db_update(studentID, batch, membership) != DB_OK) {
+        fprintf(stderr, "Error: could not record update on disk. Update aborted.\n");
+        return -1;
+    }
+
+    printf("Student ID %d updated successfully.\n", studentID);
+    return 0;
+}
+
+int deleteStudent(int studentID) {
+    int rc = db_delete(studentID);
+    if (rc == DB_ERR_NOT_FOUND) {
+        fprintf(stderr, "Student ID %d not found.\n", studentID);
+        return -1;
+    }
+    if (rc == DB_ERR_IO) {
+        fprintf(stderr, "Error: could not record deletion on disk.\n");
+        return -1;
+    }
+
+    printf("Student ID %d deleted successfully.\n", studentID);
+    return 0;
+}
+
+size_t db_each(StudentSink sink, void *ctx) {
+    size_t count = 0;
+    StudentCursor c = { 0 };
+    for (const Student *s; (s = student_next(&c)); ) {
+        if (sink) sink(s, ctx);
+        count++;
+    }
+    return count;
+}
+
+static void print_numbered(const Student *s, void *ctx) {
+    printf("---- Record %zu ----", ++*(size_t *)ctx);
+    printStudent(s);
+}
+
+void displayAllStudents(void) {
+    if (live_count() == 0) {
+        printf("No students found.\n");
+        return;
+    }
+    size_t shown = 0;
+    db_each(print_numbered, &shown);
+}
+
+// Calls visit (if any) for every live record in the batch (a batchNames code) that
+// passes the filter (an interestNames code, or ENUM_NONE for any). The
+// filter matches interest "Both" alone, or the membership, interest or "Both".
+static size_t for_each_report_match(uint8_t batchCode, uint8_t filterCode,
+                                    StudentSink visit, void *ctx) {
+    const uint64_t *batch = batchBits[batchCode];
+    const uint64_t *both = interestBits[enum_code(interestNames, NAME_COUNT(interestNames), "Both")];
+    const uint64_t *member = NULL, *interest = NULL;
+    int anyMembership = filterCode == ENUM_NONE;
+    if (!anyMembership && strcmp(interestNames[filterCode], "Both") != 0) {
+        member = membershipBits[enum_code(membershipNames, NAME_COUNT(membershipNames), interestNames[filterCode])];
+        interest = interestBits[filterCode];
+    }
+
+    size_t matches = 0;
+    size_t words = (studentCount + 63) / 64;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t match = batch[w];
+        if (!anyMembership) {
+            uint64_t filter = both[w];
+            if (member) filter |= member[w] | interest[w];
+            match &= filter;
+        }
+        while (match) {
+            if (visit) visit(student_at(w * 64 + lowest_bit(match)), ctx);
+            matches++;
+            match &= match - 1;
+        }
+    }
+    return matches;
+}
+
+static void print_report_match(const Student *s, void *ctx) {
+    (void)ctx;
+    printStudent(s);
+}
+
+// The bitmap test of for_each_report_match for one record, for paged mode's scans
+static int report_match(const Student *s, uint8_t batch, uint8_t filter) {
+    if (strcmp(s->batch, batchNames[batch]) != 0) return 0;
+    if (filter == ENUM_NONE || strcmp(s->interest, "Both") == 0) return 1;
+    const char *name = interestNames[filter];
+    return strcmp(name, "Both") != 0 && (strcmp(s->membership, name) == 0 || strcmp(s->interest, name) == 0);
+}
+
+long db_batch_report(const char *batchFilter, const char *membershipFilter, StudentSink sink, void *ctx) {
+    if (!validBatch(batchFilter)) return DB_ERR_INVALID;
+    if (strlen(membershipFilter) > 0 && !validInterest(membershipFilter)) return DB_ERR_INVALID;
+
+    uint8_t filter = strlen(membershipFilter) == 0 ? ENUM_NONE
+                   : enum_code(interestNames, NAME_COUNT(interestNames), membershipFilter);
+    uint8_t batch = enum_code(batchNames, NAME_COUNT(batchNames), batchFilter);
+    if (storageMode != STORAGE_PAGED) return (long)for_each_report_match(batch, filter, sink, ctx);
+    long found = 0;
+    StudentCursor c = { 0 };
+    for (const Student *s; (s = student_next(&c)); ) {
+        if (!report_match(s, batch, filter)) continue;
+        if (sink) sink(s, ctx);
+        found++;
+    }
+    return found;
+}
+
+void generateBatchReport(const char *batchFilter, const char *membershipFilter) {
+    if (!validBatch(batchFilter)) {
+        fprintf(stderr, "Invalid batch filter: %s\n", batchFilter);
+        return;
+    }
+    
+    if (strlen(membershipFilter) > 0 && !validInterest(membershipFilter)) {
+        fprintf(stderr, "Invalid membership filter: %s (Must be IEEE, ACM, or Both)\n", membershipFilter);
+        return;
+    }
+
+    printf("\n--- Batch Report (Batch: %s, Filter: %s) ---\n", 
+           batchFilter, 
+           strlen(membershipFilter) == 0 ? "Any" : membershipFilter);
+
+    if (db_batch_report(batchFilter, membershipFilter, print_report_match, NULL) <= 0) {
+        printf("No records matching the specified criteria.\n");
+    }
+    printf("---------------------------------------------\n");
+}
+
+
+// Finds students whose registration date (or date of birth) lies in [from, to]
+long db_date_range(int byDob, const char *from, const char *to, StudentSink sink, void *ctx) {
+    if ((strlen(from) > 0 && !validDateFormat(from)) || (strlen(to) > 0 && !validDateFormat(to))) {
+        return DB_ERR_INVALID;
+    }
+    uint32_t lo = strlen(from) > 0 ? pack_date(from) : 0;
+    uint32_t hi = strlen(to) > 0 ? pack_date(to) : UINT32_MAX;
+
+    size_t count = 0;
+    if (storageMode == STORAGE_PAGED) {
+        // No date index on disk: one scan, listed in file order rather than by date
+        StudentCursor c = { 0 };
+        for (const Student *s; (s = student_next(&c)); ) {
+            uint32_t d = pack_date(byDob ? s->dob : s->regDate);
+            if (d < lo || d > hi || d == 0) continue;
+            if (sink) sink(s, ctx);
+            count++;
+        }
+    } else {
+        int32_t *ids = date_index_range(byDob ? &dobIndex : &regDateIndex, lo, hi, &count);
+        for (size_t i = 0; sink && i < count; ++i) {
+            sink(student_at(findStudentIndexByID(ids[i])), ctx);
+        }
+        free(ids);
+    }
+    return (long)count;
+}
+
+void generateDateRangeReport(int byDob, const char *from, const char *to) {
+    if ((strlen(from) > 0 && !validDateFormat(from)) || (strlen(to) > 0 && !validDateFormat(to))) {
+        fprintf(stderr, "Invalid date range. Required: YYYY-MM-DD or empty.\n");
+        return;
+    }
+    printf("\n--- %s Report (%s to %s) ---\n", byDob ? "Date of Birth" : "Registration Date",
+           strlen(from) > 0 ? from : "any", strlen(to) > 0 ? to : "any");
+
+    long count = db_date_range(byDob, from, to, print_report_match, NULL);
+    if (count == 0) {
+        printf("No records matching the specified criteria.\n");
+    } else {
+        printf("%ld record(s) found.\n", count);
+    }
+    printf("---------------------------------------------\n");
+}
+
+// Function for interactive registration with robust input loops
+void registerStudentInteractive(void) {
+    Student s;
+    int tmp_id;
+
+    printf("\n--- New Student Registration ---\n");
+    printf("Enter Student ID (integer): ");
+    
+    // Use scanf for ID, then aggressively clear the input buffer
+    if (scanf("%d", &tmp_id) != 1) {
+        fprintf(stderr, "Invalid ID input. Registration aborted.\n");
+        int c; while ((c = getchar()) != '\n' && c != EOF); 
+        return;
+    }
+    s.id = tmp_id;
+    int c; while ((c = getchar()) != '\n' && c != EOF); // Clear buffer after scanf
+    // Optional: Add a non-standard but often effective extra clear
+    fflush(stdin); 
+
+    if (db_get(s.id, NULL) == DB_OK) {
+        fprintf(stderr, "Error: Student with ID %d already exists.\n", s.id);
+        return;
+    }
+
+    char input_buffer[NAME_LEN];
+    int valid = 0;
+
+    // 1. Full Name (NOW IN ROBUST LOOP to prevent skips)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Full Name: ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Full Name cannot be empty. Try again.\n");
+            continue;
+        }
+        strncpy(s.name, input_buffer, sizeof(s.name) - 1);
+        s.name[sizeof(s.name) - 1] = '\0';
+        valid = 1;
+    }
+    
+    // 2. Batch (Input loop ensures valid selection)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Batch (CS / SE / Cyber Security / AI): ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Batch cannot be empty. Try again.\n");
+            continue;
+        }
+        if (!validBatch(input_buffer)) { fprintf(stderr, "Invalid batch. Try again.\n"); continue; }
+        strncpy(s.batch, input_buffer, sizeof(s.batch) - 1);
+        s.batch[sizeof(s.batch) - 1] = '\0';
+        valid = 1;
+    }
+
+    // 3. Membership (Input loop ensures valid selection)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Membership (IEEE / ACM): ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Membership cannot be empty. Try again.\n");
+            continue;
+        }
+        if (!validMembership(input_buffer)) { fprintf(stderr, "Invalid membership. Try again.\n"); continue; }
+        strncpy(s.membership, input_buffer, sizeof(s.membership) - 1);
+        s.membership[sizeof(s.membership) - 1] = '\0';
+        valid = 1;
+    }
+
+    // 4. Registration Date (Input loop ensures valid YYYY-MM-DD date)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Registration Date (YYYY-MM-DD): ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Registration Date cannot be empty. Try again.\n");
+            continue;
+        }
+        if (!validDateFormat(input_buffer)) { 
+            fprintf(stderr, "Invalid date format or non-existent date (e.g., Feb 30th). Required: YYYY-MM-DD. Try again.\n"); 
+            continue; 
+        }
+        strncpy(s.regDate, input_buffer, sizeof(s.regDate) - 1);
+        s.regDate[sizeof(s.regDate) - 1] = '\0';
+        valid = 1;
+    }
+    
+    // 5. Date of Birth (Input loop ensures valid YYYY-MM-DD date)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Date of Birth (YYYY-MM-DD): ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Date of Birth cannot be empty. Try again.\n");
+            continue; // Loop again until valid input is given
+        }
+        if (!validDateFormat(input_buffer)) { 
+            fprintf(stderr, "Invalid date format or non-existent date (e.g., Feb 30th). Required: YYYY-MM-DD. Try again.\n"); 
+            continue; 
+        }
+        strncpy(s.dob, input_buffer, sizeof(s.dob) - 1);
+        s.dob[sizeof(s.dob) - 1] = '\0';
+        valid = 1;
+    }
+
+    // 6. Interest (Input loop ensures valid selection)
+    valid = 0;
+    while(!valid) {
+        read_line_input("Interest (IEEE / ACM / Both): ", input_buffer, sizeof(input_buffer));
+        if (strlen(input_buffer) == 0) { 
+            fprintf(stderr, "Interest cannot be empty. Try again.\n");
+            continue;
+        }
+        if (!validInterest(input_buffer)) { fprintf(stderr, "Invalid interest option. Try again.\n"); continue; }
+        strncpy(s.interest, input_buffer, sizeof(s.interest) - 1);
+        s.interest[sizeof(s.interest) - 1] = '\0';
+        valid = 1;
+    }
+
+    if (addStudent(&s) == 0) {
+        printf("Student ID %d registered successfully.\n", s.id);
+    } else {
+        fprintf(stderr, "Failed to register student.\n");
+    }
+}
+
+
+static Student createMockStudent(int id) {
+    static const char *names[] = {"Aamir Khan", "Sara Ali", "Usman Tariq", "Javeria Nasir", "Zainab Raza", "Tariq Ali", "Ayesha Ahmed"};
+    static const char *batches[] = {"CS", "SE", "Cyber Security", "AI"};
+    static const char *memberships[] = {"IEEE", "ACM"};
+    static const char *interests[] = {"IEEE", "ACM", "Both"};
+
+    Student s;
+    s.id = id;
     
-    if (saveDatabase(DATAFILE) != 0) {
-        fprintf(stderr, "Warning: update succeeded in memory but failed to save to disk.\n");
+    strncpy(s.name, names[rand() % (sizeof(names) / sizeof(names[0]))], NAME_LEN - 1);
+    s.name[NAME_LEN - 1] = '\0';
+    strncpy(s.batch, batches[rand() % (sizeof(batches) / sizeof(batches[0]))], 31);
+    s.batch[31] = '\0';
+    strncpy(s.membership, memberships[rand() % (sizeof(memberships) / sizeof(memberships[0]))], 7);
+    s.membership[7] = '\0';
+    strncpy(s.interest, interests[rand() % (sizeof(interests) / sizeof(interests[0]))], 7);
+    s.interest[7] = '\0';
+
+    snprintf(s.regDate, DATE_LEN, "2024-09-%02u", (unsigned)rand() % 30 + 1);
+    snprintf(s.dob, DATE_LEN, "2000-01-%02u", (unsigned)rand() % 28 + 1);
+
+    return s;
+}
+
+// Registers `count` records as one batch: a few large writes and one commit
+size_t addStudents(const Student *recs, size_t count) {
+    size_t added = 0;
+    beginBatch();
+    for (size_t i = 0; i < count; ++i) {
+        if (addStudent(&recs[i]) == 0) added++;
+    }
+    if (commitBatch() != 0) {
+        fprintf(stderr, "Error: could not commit the batch to disk.\n");
+    }
+    return added;
+}
+
+// Registers `count` mock students with fresh ids through addStudents and reports the rate
+void bulkRegisterMock(size_t count) {
+    if (count == 0) return;
+    Student *batch = malloc(count * sizeof(Student));
+    if (!batch) {
+        perror("malloc");
+        return;
+    }
+    int nextId = 0;
+    StudentCursor c = { 0 };
+    for (const Student *s; (s = student_next(&c)); ) {
+        if (s->id >= nextId) nextId = s->id + 1;
+    }
+    for (size_t i = 0; i < count; ++i) batch[i] = createMockStudent(nextId + (int)i);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t added = addStudents(batch, count);
+    double secs = elapsed_ms(&start) / 1000.0;
+    printf("Registered %zu students in %.3f s (%.0f per second, durability %s).\n",
+           added, secs, secs > 0 ? added / secs : 0.0, durabilityNames[durability]);
+    free(batch);
+}
+
+// --- CSV Import/Export ---
+// Columns are id,name,batch,membership,regDate,dob,interest, optionally under
+// a header row. A field may be double-quoted, with "" for a quote inside;
+// quoted fields cannot span lines. Import reads the file a block at a time,
+// splits rows in place, validates every field without sscanf or copies and
+// registers all accepted rows as one batch.
+
+// Ids seen earlier in the file, with the line that introduced them (0 = empty)
+typedef struct {
+    int32_t id;
+    uint32_t line;
+} CsvSeen;
+
+typedef struct {
+    CsvSeen *slots;
+    size_t capacity, count;
+} CsvIdSet;
+
+// Returns the line that already holds id, or 0 after adding it for `line`
+static uint32_t csv_seen_add(CsvIdSet *set, int32_t id, uint32_t line) {
+    if ((set->count + 1) * 10 > set->capacity * 7) {
+        CsvIdSet grown = { calloc(set->capacity ? set->capacity * 2 : 1024, sizeof(CsvSeen)), 0, 0 };
+        if (!grown.slots) {
+            perror("calloc");
+            fprintf(stderr, "Fatal: Out of memory while checking CSV ids.\n");
+            exit(EXIT_FAILURE);
+        }
+        grown.capacity = set->capacity ? set->capacity * 2 : 1024;
+        for (size_t i = 0; i < set->capacity; ++i) {
+            if (set->slots[i].line) csv_seen_add(&grown, set->slots[i].id, set->slots[i].line);
+        }
+        free(set->slots);
+        *set = grown;
+    }
+    size_t mask = set->capacity - 1;
+    size_t pos = id_hash(id) & mask;
+    while (set->slots[pos].line) {
+        if (set->slots[pos].id == id) return set->slots[pos].line;
+        pos = (pos + 1) & mask;
+    }
+    set->slots[pos].id = id;
+    set->slots[pos].line = line;
+    set->count++;
+    return 0;
+}
+
+// Splits one row in place; quoted fields are unescaped where they stand.
+// Returns the field count, or -1 for bad quoting or too many fields.
+static int csv_split(char *p, char *end, char **fields, size_t *lens) {
+    int n = 0;
+    for (;;) {
+        if (n == CSV_FIELDS) return -1;
+        char *start = p, *out;
+        if (p < end && *p == '"') {
+            out = start;
+            for (++p;; ) {
+                if (p == end) return -1;
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') {
+                        *out++ = '"';
+                        p += 2;
+                        continue;
+                    }
+                    p++;
+                    break;
+                }
+                *out++ = *p++;
+            }
+            if (p < end && *p != ',') return -1;
+        } else {
+            char *comma = memchr(p, ',', (size_t)(end - p));
+            p = comma ? comma : end;
+            out = p;
+        }
+        fields[n] = start;
+        lens[n] = (size_t)(out - start);
+        n++;
+        if (p == end) return n;
+        p++;
+    }
+}
+
+static int csv_parse_id(const char *p, size_t len, int *out) {
+    int negative = len > 0 && *p == '-';
+    if (negative) {
+        p++;
+        len--;
+    }
+    if (len == 0 || len > 10) return 0;
+    long long v = 0;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned digit = (unsigned char)p[i] - (unsigned)'0';
+        if (digit > 9) return 0;
+        v = v * 10 + digit;
+    }
+    if (negative) v = -v;
+    if (v < INT_MIN || v > INT_MAX) return 0;
+    *out = (int)v;
+    return 1;
+}
+
+// Fills s from one split row (fields NUL-terminated); returns NULL or the reason it was rejected
+static const char *csv_row_to_student(char **f, const size_t *len, Student *s) {
+    memset(s, 0, sizeof(*s));
+    if (!csv_parse_id(f[0], len[0], &s->id)) return "id is not a 32-bit integer";
+    if (s->id == TOMBSTONE_ID) return "id is reserved";
+    if (len[1] == 0) return "name is empty";
+    if (len[1] >= sizeof(s->name)) return "name is too long";
+    uint8_t batch = enum_code(batchNames, NAME_COUNT(batchNames), f[2]);
+    uint8_t membership = enum_code(membershipNames, NAME_COUNT(membershipNames), f[3]);
+    uint8_t interest = enum_code(interestNames, NAME_COUNT(interestNames), f[6]);
+    if (batch == ENUM_NONE) return "unknown batch";
+    if (membership == ENUM_NONE) return "unknown membership";
+    if (!parse_date(f[4], len[4])) return "invalid registration date";
+    if (!parse_date(f[5], len[5])) return "invalid date of birth";
+    if (interest == ENUM_NONE) return "unknown interest";
+
+    memcpy(s->name, f[1], len[1]);
+    strcpy(s->batch, batchNames[batch]);
+    strcpy(s->membership, membershipNames[membership]);
+    memcpy(s->regDate, f[4], 10);
+    memcpy(s->dob, f[5], 10);
+    strcpy(s->interest, interestNames[interest]);
+    return NULL;
+}
+
+typedef struct {
+    const char *path;
+    uint32_t line;
+    size_t rejected;
+    Student *rows;
+    size_t rowCount, rowCapacity;
+    CsvIdSet seen;
+} CsvImport;
+
+static void csv_reject(CsvImport *im, const char *reason) {
+    if (im->rejected++ < CSV_ERRORS_SHOWN) fprintf(stderr, "%s:%u: %s\n", im->path, (unsigned)im->line, reason);
+}
+
+static void csv_import_row(CsvImport *im, char *p, char *end) {
+    if (end > p && end[-1] == '\r') end--;
+    if (end == p) return;   // blank line
+
+    char *fields[CSV_FIELDS];
+    size_t lens[CSV_FIELDS];
+    int n = csv_split(p, end, fields, lens);
+    if (n != CSV_FIELDS) {
+        // A header naming the columns is allowed as the first row
+        if (!(im->line == 1 && n > 0 && lens[0] == 2 && memcmp(fields[0], "id", 2) == 0)) {
+            csv_reject(im, n < 0 ? "bad quoting or more than 7 fields" : "expected 7 fields");
+        }
+        return;
+    }
+    for (int i = 0; i < CSV_FIELDS; ++i) fields[i][lens[i]] = '\0';
+    if (im->line == 1 && strcmp(fields[0], "id") == 0) return;
+
+    Student s;
+    const char *reason = csv_row_to_student(fields, lens, &s);
+    if (reason) {
+        csv_reject(im, reason);
+        return;
+    }
+    if (db_get(s.id, NULL) == DB_OK) {
+        csv_reject(im, "id is already registered");
+        return;
+    }
+    uint32_t first = csv_seen_add(&im->seen, s.id, im->line);
+    if (first) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "id repeats line %u", (unsigned)first);
+        csv_reject(im, msg);
+        return;
+    }
+
+    if (im->rowCount == im->rowCapacity) {
+        size_t newCap = im->rowCapacity ? im->rowCapacity * 2 : 1024;
+        Student *tmp = realloc(im->rows, newCap * sizeof(Student));
+        if (!tmp) {
+            perror("realloc");
+            fprintf(stderr, "Fatal: Out of memory while importing CSV rows.\n");
+            exit(EXIT_FAILURE);
+        }
+        im->rows = tmp;
+        im->rowCapacity = newCap;
+    }
+    im->rows[im->rowCount++] = s;
+}
+
+// Imports every valid row of a CSV file; returns the number registered, or -1 if the file cannot be read
+long importCSV(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for import.\n", path);
+        return -1;
+    }
+    char *buf = malloc(CSV_BLOCK + 1);     // +1 so the last field can be NUL-terminated
+    if (!buf) {
+        perror("malloc");
+        fclose(f);
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CsvImport im = { path, 0, 0, NULL, 0, 0, { NULL, 0, 0 } };
+    size_t have = 0;
+    int eof = 0, skipping = 0;
+    while (!eof || have > 0) {
+        if (!eof) {
+            size_t n = fread(buf + have, 1, CSV_BLOCK - have, f);
+            have += n;
+            eof = n == 0 || feof(f) || ferror(f);
+        }
+        // Rows end at the last newline; a final row without one ends at EOF
+        char *end = buf + have;
+        while (end > buf && end[-1] != '\n') end--;
+        if (end == buf) {
+            if (!eof && have < CSV_BLOCK) continue;
+            end = buf + have;
+        }
+
+        char *p = buf;
+        while (p < end) {
+            char *nl = memchr(p, '\n', (size_t)(end - p));
+            char *rowEnd = nl ? nl : end;
+            if (skipping) {
+                skipping = nl == NULL;
+            } else {
+                im.line++;
+                if (!nl && !eof) {
+                    // A row longer than the whole block: drop it up to its newline
+                    csv_reject(&im, "row is too long");
+                    skipping = 1;
+                } else {
+                    csv_import_row(&im, p, rowEnd);
+                }
+            }
+            p = nl ? nl + 1 : end;
+        }
+        have -= (size_t)(end - buf);
+        memmove(buf, end, have);
+    }
+    int readError = ferror(f);
+    fclose(f);
+    free(buf);
+    free(im.seen.slots);
+    if (readError) {
+        fprintf(stderr, "Error: could not read '%s'; nothing imported.\n", path);
+        free(im.rows);
+        return -1;
+    }
+
+    size_t added = addStudents(im.rows, im.rowCount);
+    free(im.rows);
+    if (im.rejected > CSV_ERRORS_SHOWN) {
+        fprintf(stderr, "%s: ... and %zu more rejected rows\n", path, im.rejected - CSV_ERRORS_SHOWN);
+    }
+    double secs = elapsed_ms(&start) / 1000.0;
+    printf("Imported %zu rows from '%s' in %.3f s; %zu rejected.\n", added, path, secs, im.rejected);
+    return (long)added;
+}
+
+static void csv_write_field(FILE *f, const char *s) {
+    if (!strpbrk(s, ",\"\r\n")) {
+        fputs(s, f);
+        return;
+    }
+    fputc('"', f);
+    for (; *s; ++s) {
+        if (*s == '"') fputc('"', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+static void csv_write_row(FILE *f, const Student *s) {
+    fprintf(f, "%d,", s->id);
+    csv_write_field(f, s->name);
+    fputc(',', f);
+    csv_write_field(f, s->batch);
+    fputc(',', f);
+    csv_write_field(f, s->membership);
+    fputc(',', f);
+    csv_write_field(f, s->regDate);
+    fputc(',', f);
+    csv_write_field(f, s->dob);
+    fputc(',', f);
+    csv_write_field(f, s->interest);
+    fputc('\n', f);
+}
+
+// Streams every live record to a CSV file in registration order
+int exportCSV(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for export.\n", path);
+        return -1;
+    }
+    setvbuf(f, NULL, _IOFBF, CSV_BLOCK);
+
+    fputs("id,name,batch,membership,regDate,dob,interest\n", f);
+    size_t written = 0;
+    StudentCursor c = { 0 };
+    for (const Student *s; (s = student_next(&c)); ++written) csv_write_row(f, s);
+    if (ferror(f) | fclose(f)) {
+        perror("fwrite");
+        fprintf(stderr, "Error: export to '%s' is incomplete.\n", path);
+        return -1;
+    }
+    printf("Exported %zu records to '%s'.\n", written, path);
+    return 0;
+}
+
+// Checks that the data file holds exactly the records in memory and that
+// its header checksum matches them; the journal must be folded in first
+static int verify_data_file(void) {
+    size_t count = 0;
+    int ok = 0;
+    FILE *f = fopen(DATAFILE, "rb");
+    if (f) {
+        FileHeader header;
+        DiskRecord rec;
+        uint32_t sum = 0;
+        if (fread(&header, sizeof(header), 1, f) == 1 && header_valid(&header)) {
+            while (fread(&rec, sizeof(rec), 1, f) == 1) {
+                sum += record_checksum(&rec);
+                count++;
+            }
+            ok = count == header.count && sum == header.checksum;
+        }
+        fclose(f);
+    }
+    return ok && count == studentCount;
+}
+
+// --- Benchmark ---
+// Preloads `records` mock students as one batch, then times `ops` operations
+// drawn from a weighted mix, with keys from a uniform, zipf (s = 1, hot
+// keys are the oldest ids) or latest (zipf counted back from the newest id)
+// distribution. Every operation is timed on its own; the report gives
+// throughput and p50/p99/p999 latency per operation as JSON. The run uses
+// the current storage, delete and durability settings, in a scratch
+// directory so the real members.dat is never touched.
+// BenchConfig and the BENCH_* and KEYS_* values are in the header.
+static const char *const benchOpNames[BENCH_OPS] = { "add", "update", "delete", "lookup", "report" };
+static const char *const keyDistributionNames[] = { "uniform", "zipf", "latest" };
+
+#ifndef PF_LIBRARY
+static const BenchConfig benchDefaults = { 1, 10000, 10000, { 10, 20, 5, 60, 5 }, KEYS_UNIFORM, 0, "-" };
+#endif
+
+typedef struct {
+    uint64_t *ns;
+    size_t count, capacity;
+    size_t hits;                // found / changed / matched something
+    uint64_t totalNs;
+} BenchSamples;
+
+#ifndef PF_LIBRARY
+// Parses "add=10,lookup=90,..."; ops left out get weight 0
+static int parse_mix(const char *spec, unsigned mix[BENCH_OPS]) {
+    unsigned total = 0;
+    memset(mix, 0, BENCH_OPS * sizeof(unsigned));
+    while (*spec) {
+        const char *eq = strchr(spec, '=');
+        if (!eq) return -1;
+        int op = -1;
+        for (int k = 0; k < BENCH_OPS; ++k) {
+            if (strlen(benchOpNames[k]) == (size_t)(eq - spec) && strncmp(spec, benchOpNames[k], eq - spec) == 0) op = k;
+        }
+        char *end;
+        unsigned long w = strtoul(eq + 1, &end, 10);
+        if (op < 0 || end == eq + 1 || (*end && *end != ',') || w > 1000000) return -1;
+        mix[op] = (unsigned)w;
+        total += (unsigned)w;
+        spec = *end ? end + 1 : end;
+    }
+    return total > 0 ? 0 : -1;
+}
+#endif
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_record(BenchSamples *s, uint64_t ns, int hit) {
+    if (s->count == s->capacity) {
+        size_t newCap = s->capacity ? s->capacity * 2 : 1024;
+        uint64_t *tmp = realloc(s->ns, newCap * sizeof(uint64_t));
+        if (!tmp) {
+            perror("realloc");
+            fprintf(stderr, "Fatal: Out of memory while recording latencies.\n");
+            exit(EXIT_FAILURE);
+        }
+        s->ns = tmp;
+        s->capacity = newCap;
+    }
+    s->ns[s->count++] = ns;
+    s->totalNs += ns;
+    s->hits += hit != 0;
+}
+
+static int u64_cmp(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples, in microseconds
+static double bench_percentile_us(const BenchSamples *s, double p) {
+    if (s->count == 0) return 0;
+    size_t rank = (size_t)(p * (double)s->count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > s->count) rank = s->count;
+    return s->ns[rank - 1] / 1000.0;
+}
+
+static double bench_uniform(void) {
+    return rand() / ((double)RAND_MAX + 1.0);
+}
+
+// Draws a rank in [0, n) from the zipf table, or uniformly without one
+static size_t bench_rank(const double *zipfCdf, size_t n) {
+    if (n == 0) return 0;
+    if (!zipfCdf) return (size_t)(bench_uniform() * (double)n);
+    double u = bench_uniform() * zipfCdf[n - 1];
+    size_t lo = 0, hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (zipfCdf[mid] <= u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int bench_key(const BenchConfig *cfg, const double *zipfCdf, int nextId) {
+    size_t issued = (size_t)(nextId - 1);
+    if (issued == 0) return 0;
+    switch (cfg->keys) {
+    case KEYS_ZIPF:
+        return 1 + (int)bench_rank(zipfCdf, cfg->records < issued ? cfg->records : issued);
+    case KEYS_LATEST:
+        return nextId - 1 - (int)bench_rank(zipfCdf, cfg->records < issued ? cfg->records : issued);
+    default:
+        return 1 + (int)bench_rank(NULL, issued);
+    }
+}
+
+static void count_report_match(const Student *s, void *ctx) {
+    (void)s;
+    (*(size_t *)ctx)++;
+}
+
+// Drops the in-memory database without closing the journal stream, which
+// after a fork still belongs to the parent
+static void forget_database(void) {
+    journalFile = NULL;
+    pool_free();
+    inplace_close();
+    free_segments();
+    studentCount = 0;
+    free(freeSlots);
+    freeSlots = NULL;
+    freeSlotCount = freeSlotCapacity = 0;
+    free(staged);
+    staged = NULL;
+    stagedCount = stagedCapacity = 0;
+    pendingWrites = 0;
+    batchDepth = 0;
+    journalEntries = 0;
+    baseDamaged = 0;
+    legacyHeld = 0;
+    storageMode = STORAGE_JOURNAL;
+    id_index_free();
+    bitmap_free();
+    date_index_free(&regDateIndex);
+    date_index_free(&dobIndex);
+}
+
+// Commits what is pending, checkpoints a paged database and frees every table
+int closeDatabase(void) {
+    int rc = commitWrites();
+    if (paged_close() != 0) rc = -1;
+    journal_close();
+    forget_database();
+    return rc;
+}
+
+// Creates and enters a scratch directory from the template in `dir`
+static int scratch_enter(char *dir) {
+    if (!mkdtemp(dir) || chdir(dir) != 0) {
+        perror("mkdtemp");
+        return -1;
+    }
+    return 0;
+}
+
+// Removes every database file from the scratch directory, then the directory
+static void scratch_leave(const char *dir) {
+    char path[512];
+    journal_path(DATAFILE, path, sizeof(path));
+    remove(path);
+    snprintf(path, sizeof(path), "%s.tmp", DATAFILE);
+    remove(path);
+    snprintf(path, sizeof(path), "%s.base", DATAFILE);
+    remove(path);
+    redo_path(DATAFILE, path, sizeof(path));
+    remove(path);
+    idx_path(DATAFILE, path, sizeof(path));
+    remove(path);
+    strcat(path, ".base");
+    remove(path);
+    remove(DATAFILE);
+    if (chdir("..") != 0 || rmdir(dir) != 0) perror("rmdir");
+}
+
+static void bench_write_json(FILE *out, const BenchConfig *cfg, double loadSecs, double runSecs,
+                             double saveSecs, BenchSamples *samples, int verified) {
+    static const char *const deleteModeNames[] = { "shift", "swap", "tombstone" };
+    fprintf(out, "{\n  \"seed\": %u,\n  \"records\": %zu,\n  \"ops\": %zu,\n", cfg->seed, cfg->records, cfg->ops);
+    fprintf(out, "  \"mix\": {");
+    for (int k = 0; k < BENCH_OPS; ++k) fprintf(out, "%s\"%s\": %u", k ? ", " : "", benchOpNames[k], cfg->mix[k]);
+    fprintf(out, "},\n  \"distribution\": \"%s\",\n  \"storage\": \"%s\",\n  \"delete_mode\": \"%s\",\n"
+                 "  \"durability\": \"%s\",\n",
+            keyDistributionNames[cfg->keys], cfg->inPlace ? "inplace" : "journal", deleteModeNames[deleteMode],
+            durabilityNames[durability]);
+    fprintf(out, "  \"load\": {\"seconds\": %.6f, \"records_per_sec\": %.1f},\n",
+            loadSecs, loadSecs > 0 ? cfg->records / loadSecs : 0.0);
+    fprintf(out, "  \"run\": {\"seconds\": %.6f, \"ops_per_sec\": %.1f},\n",
+            runSecs, runSecs > 0 ? cfg->ops / runSecs : 0.0);
+    fprintf(out, "  \"operations\": {\n");
+    for (int k = 0; k < BENCH_OPS; ++k) {
+        BenchSamples *s = &samples[k];
+        if (s->count) qsort(s->ns, s->count, sizeof(uint64_t), u64_cmp);
+        double secs = s->totalNs / 1e9;
+        fprintf(out, "    \"%s\": {\"count\": %zu, \"hits\": %zu, \"ops_per_sec\": %.1f, \"mean_us\": %.3f, "
+                     "\"p50_us\": %.3f, \"p99_us\": %.3f, \"p999_us\": %.3f}%s\n",
+                benchOpNames[k], s->count, s->hits, secs > 0 ? s->count / secs : 0.0,
+                s->count ? s->totalNs / 1000.0 / s->count : 0.0, bench_percentile_us(s, 0.50),
+                bench_percentile_us(s, 0.99), bench_percentile_us(s, 0.999), k + 1 < BENCH_OPS ? "," : "");
+    }
+    fprintf(out, "  },\n  \"save_seconds\": %.6f,\n  \"verified\": %s\n}\n", saveSecs, verified ? "true" : "false");
+}
+
+// Runs one benchmark from an empty database; the caller's in-memory database is discarded
+int runBenchmark(const BenchConfig *cfg) {
+    FILE *out = strcmp(cfg->output, "-") == 0 ? stdout : fopen(cfg->output, "w");
+    if (!out) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for benchmark results.\n", cfg->output);
+        return -1;
+    }
+    char dir[] = "members-bench-XXXXXX";
+    if (scratch_enter(dir) != 0) {
+        if (out != stdout) fclose(out);
+        return -1;
+    }
+
+    forget_database();
+    ensure_capacity(INITIAL_CAPACITY);
+    int rc = loadDatabase(DATAFILE);
+    if (rc == 0 && cfg->inPlace) rc = inplace_open(DATAFILE);
+
+    double *zipfCdf = NULL;
+    if (rc == 0 && cfg->keys != KEYS_UNIFORM && cfg->records > 0) {
+        zipfCdf = malloc(cfg->records * sizeof(double));
+        if (!zipfCdf) {
+            perror("malloc");
+            rc = -1;
+        } else {
+            double sum = 0;
+            for (size_t i = 0; i < cfg->records; ++i) zipfCdf[i] = sum += 1.0 / (double)(i + 1);
+        }
+    }
+
+    // Preload in chunks so the mock records never need a second full copy
+    srand(cfg->seed);
+    uint64_t start = bench_now_ns();
+    int nextId = 1;
+    if (rc == 0) {
+        Student *chunk = malloc(BENCH_PRELOAD_CHUNK * sizeof(Student));
+        if (!chunk) {
+            perror("malloc");
+            rc = -1;
+        } else {
+            beginBatch();
+            for (size_t done = 0; done < cfg->records; ) {
+                size_t n = cfg->records - done < BENCH_PRELOAD_CHUNK ? cfg->records - done : BENCH_PRELOAD_CHUNK;
+                for (size_t i = 0; i < n; ++i) chunk[i] = createMockStudent(nextId++);
+                addStudents(chunk, n);
+                done += n;
+            }
+            if (commitBatch() != 0) rc = -1;
+            free(chunk);
+        }
+    }
+    double loadSecs = (bench_now_ns() - start) / 1e9;
+
+    BenchSamples samples[BENCH_OPS];
+    memset(samples, 0, sizeof(samples));
+    unsigned totalWeight = 0;
+    for (int k = 0; k < BENCH_OPS; ++k) totalWeight += cfg->mix[k];
+
+    start = bench_now_ns();
+    for (size_t n = 0; rc == 0 && n < cfg->ops; ++n) {
+        unsigned pick = (unsigned)(bench_uniform() * totalWeight);
+        int op = 0;
+        while (pick >= cfg->mix[op]) pick -= cfg->mix[op++];
+
+        int id = bench_key(cfg, zipfCdf, nextId);
+        Student s;
+        const char *batch = batchNames[rand() % NAME_COUNT(batchNames)];
+        const char *membership = membershipNames[rand() % NAME_COUNT(membershipNames)];
+        uint8_t reportBatch = (uint8_t)(rand() % NAME_COUNT(batchNames));
+        uint8_t reportFilter = (uint8_t)(rand() % (NAME_COUNT(interestNames) + 1));
+        if (reportFilter == NAME_COUNT(interestNames)) reportFilter = ENUM_NONE;
+        if (op == BENCH_ADD) s = createMockStudent(nextId++);
+
+        int hit = 0;
+        size_t matches = 0;
+        uint64_t t0 = bench_now_ns();
+        switch (op) {
+        case BENCH_ADD:
+            hit = db_add(&s) == DB_OK;
+            break;
+        case BENCH_UPDATE:
+            hit = db_update(id, batch, membership) == DB_OK;
+            break;
+        case BENCH_DELETE:
+            hit = db_delete(id) == DB_OK;
+            break;
+        case BENCH_LOOKUP: {
+            long idx = findStudentIndexByID(id);
+            if (idx != -1) s = *student_at(idx);
+            hit = idx != -1;
+            break;
+        }
+        default:
+            hit = for_each_report_match(reportBatch, reportFilter, count_report_match, &matches) > 0;
+        }
+        bench_record(&samples[op], bench_now_ns() - t0, hit);
+    }
+    if (rc == 0 && commitWrites() != 0) rc = -1;
+    double runSecs = (bench_now_ns() - start) / 1e9;
+
+    start = bench_now_ns();
+    int verified = rc == 0 && saveDatabase(DATAFILE) == 0 && verify_data_file();
+    double saveSecs = (bench_now_ns() - start) / 1e9;
+
+    if (rc == 0) bench_write_json(out, cfg, loadSecs, runSecs, saveSecs, samples, verified);
+    if (out != stdout) {
+        if (fclose(out) != 0) rc = -1;
+    } else {
+        fflush(stdout);
+    }
+
+    for (int k = 0; k < BENCH_OPS; ++k) free(samples[k].ns);
+    free(zipfCdf);
+    journal_close();
+    forget_database();
+    scratch_leave(dir);
+    return rc == 0 && verified ? 0 : -1;
+}
+
+#ifndef PF_LIBRARY
+// Runs the benchmark in a child process so the loaded database is left alone
+static int runBenchmarkDetached(const BenchConfig *cfg) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        // _exit: the inherited journal stream must not be flushed twice
+        int rc = runBenchmark(cfg);
+        fflush(stdout);
+        _exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        return -1;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ? 0 : -1;
+}
+#endif
+
+
+// --- Server Mode ---
+// Serves the loaded database over a Unix domain socket. Each request is a
+// fixed-size ServerRequest; each reply is a ServerReply followed by `count`
+// DiskRecords. Lookups and reports hold dbLock as readers, so they never
+// wait on each other; register, update and delete hold it as writers.
+// A connection stays with one pool thread until the client hangs up.
+enum { REQ_REGISTER = 1, REQ_LOOKUP, REQ_UPDATE, REQ_DELETE, REQ_REPORT };
+
+typedef struct {
+    uint8_t op;
+    uint8_t batch;              // REQ_REPORT: batchNames code
+    uint8_t filter;             // REQ_REPORT: interestNames code, ENUM_NONE for any
+    uint8_t reserved;
+    int32_t id;                 // REQ_LOOKUP, REQ_UPDATE, REQ_DELETE
+    DiskRecord record;          // REQ_REGISTER: new record; REQ_UPDATE: batch and membership (ENUM_NONE keeps)
+} ServerRequest;
+
+typedef struct {
+    int32_t status;             // DB_OK or a DB_ERR_* code
+    uint32_t count;             // DiskRecords that follow
+} ServerReply;
+
+static pthread_rwlock_t dbLock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Group commit: writers take a sequence number and, at DURABILITY_GROUP,
+// wait until the committer thread has committed past it
+static pthread_mutex_t commitLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t commitCond = PTHREAD_COND_INITIALIZER;
+static uint64_t writeSeq = 0;
+static uint64_t committedSeq = 0;
+static uint64_t failedSeq = 0;      // last sequence covered by a commit that failed
+static int serverDraining = 0;      // set under commitLock once the accept loop ends
+
+static pthread_mutex_t queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queueNotEmpty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queueNotFull = PTHREAD_COND_INITIALIZER;
+static int clientQueue[SERVER_QUEUE_MAX];
+static size_t queueHead = 0, queueCount = 0;
+
+static volatile sig_atomic_t serverStopping = 0;    // only the accept loop reads this
+
+static int valid_student(const Student *s) {
+    return s->name[0] != '\0' && validBatch(s->batch) && validMembership(s->membership) &&
+           validInterest(s->interest) && validDateFormat(s->regDate) && validDateFormat(s->dob);
+}
+
+// Records a successful write and returns its sequence number (caller holds dbLock as writer)
+static uint64_t note_write(void) {
+    pthread_mutex_lock(&commitLock);
+    uint64_t seq = ++writeSeq;
+    pthread_mutex_unlock(&commitLock);
+    return seq;
+}
+
+// DB_OK once the write is committed, DB_ERR_IO if the commit covering it
+// failed. A waiter that wakes after later commits judges by the last failure,
+// so it may report a committed write as failed, never the reverse.
+static int wait_for_commit(uint64_t seq) {
+    if (durability != DURABILITY_GROUP) return DB_OK;
+    pthread_mutex_lock(&commitLock);
+    while (committedSeq < seq && !serverDraining) pthread_cond_wait(&commitCond, &commitLock);
+    int status = seq <= failedSeq ? DB_ERR_IO : DB_OK;
+    pthread_mutex_unlock(&commitLock);
+    return status;
+}
+
+static void *committer_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        long ms = commitWindowMs > 0 ? commitWindowMs : 1;
+        struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+
+        pthread_mutex_lock(&commitLock);
+        uint64_t seq = writeSeq;
+        int idle = seq == committedSeq, done = serverDraining;
+        pthread_mutex_unlock(&commitLock);
+        if (done) break;
+        if (idle) continue;
+
+        pthread_rwlock_wrlock(&dbLock);
+        int failed = commitWrites() != 0;
+        if (failed) fprintf(stderr, "Warning: group commit failed.\n");
+        pthread_rwlock_unlock(&dbLock);
+
+        pthread_mutex_lock(&commitLock);
+        if (failed) failedSeq = seq;
+        committedSeq = seq;
+        pthread_cond_broadcast(&commitCond);
+        pthread_mutex_unlock(&commitLock);
+    }
+    return NULL;
+}
+
+typedef struct {
+    DiskRecord *recs;
+    size_t count, cap;
+} RecordBuffer;
+
+static void collect_report_match(const Student *s, void *ctx) {
+    RecordBuffer *buf = ctx;
+    if (buf->count == buf->cap) {
+        size_t newCap = buf->cap ? buf->cap * 2 : 64;
+        DiskRecord *tmp = realloc(buf->recs, newCap * sizeof(DiskRecord));
+        if (!tmp) return;   // reply with what fits
+        buf->recs = tmp;
+        buf->cap = newCap;
+    }
+    encode_record(s, &buf->recs[buf->count++]);
+}
+
+static int send_reply(int fd, int32_t status, const DiskRecord *recs, size_t count) {
+    ServerReply reply = { status, (uint32_t)count };
+    if (write_full(fd, &reply, sizeof(reply)) != 0) return -1;
+    return count ? write_full(fd, recs, count * sizeof(DiskRecord)) : 0;
+}
+
+static void serve_client(int fd) {
+    ServerRequest req;
+    while (read_full(fd, &req, sizeof(req)) == 0) {
+        int32_t status = DB_OK;
+        uint64_t seq = 0;
+        DiskRecord rec;
+        RecordBuffer report = { NULL, 0, 0 };
+        size_t count = 0;
+        Student s;
+
+        switch (req.op) {
+        case REQ_LOOKUP: {
+            pthread_rwlock_rdlock(&dbLock);
+            long idx = findStudentIndexByID(req.id);
+            if (idx != -1) encode_record(student_at(idx), &rec);
+            pthread_rwlock_unlock(&dbLock);
+            status = idx != -1 ? DB_OK : DB_ERR_NOT_FOUND;
+            count = idx != -1;
+            break;
+        }
+        case REQ_REPORT:
+            if (req.batch >= NAME_COUNT(batchNames) ||
+                (req.filter != ENUM_NONE && req.filter >= NAME_COUNT(interestNames))) {
+                status = DB_ERR_INVALID;
+                break;
+            }
+            pthread_rwlock_rdlock(&dbLock);
+            for_each_report_match(req.batch, req.filter, collect_report_match, &report);
+            pthread_rwlock_unlock(&dbLock);
+            break;
+        case REQ_REGISTER:
+            decode_record(&req.record, &s);
+            if (!valid_student(&s)) {
+                status = DB_ERR_INVALID;
+                break;
+            }
+            pthread_rwlock_wrlock(&dbLock);
+            status = db_add(&s);
+            if (status == DB_OK) seq = note_write();
+            pthread_rwlock_unlock(&dbLock);
+            break;
+        case REQ_UPDATE: {
+            const char *batch = req.record.batch == ENUM_NONE ? NULL
+                              : enum_name(batchNames, NAME_COUNT(batchNames), req.record.batch);
+            const char *membership = req.record.membership == ENUM_NONE ? NULL
+                                   : enum_name(membershipNames, NAME_COUNT(membershipNames), req.record.membership);
+            if ((batch && !*batch) || (membership && !*membership)) {
+                status = DB_ERR_INVALID;
+                break;
+            }
+            pthread_rwlock_wrlock(&dbLock);
+            status = db_update(req.id, batch, membership);
+            if (status == DB_OK) seq = note_write();
+            pthread_rwlock_unlock(&dbLock);
+            break;
+        }
+        case REQ_DELETE:
+            pthread_rwlock_wrlock(&dbLock);
+            status = db_delete(req.id);
+            if (status == DB_OK) seq = note_write();
+            pthread_rwlock_unlock(&dbLock);
+            break;
+        default:
+            status = DB_ERR_INVALID;
+        }
+
+        if (seq) status = wait_for_commit(seq);
+        int rc = req.op == REQ_REPORT ? send_reply(fd, status, report.recs, report.count)
+                                      : send_reply(fd, status, &rec, count);
+        free(report.recs);
+        if (rc != 0) break;
+    }
+    close(fd);
+}
+
+static void *server_worker_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&queueLock);
+        while (queueCount == 0) pthread_cond_wait(&queueNotEmpty, &queueLock);
+        int fd = clientQueue[queueHead];
+        queueHead = (queueHead + 1) % SERVER_QUEUE_MAX;
+        queueCount--;
+        pthread_cond_signal(&queueNotFull);
+        pthread_mutex_unlock(&queueLock);
+        serve_client(fd);
+    }
+    return NULL;
+}
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    int savedErrno = errno;
+    serverStopping = 1;
+    errno = savedErrno;
+}
+
+// Runs until SIGINT/SIGTERM, then commits and saves the database
+int runServer(const char *socketPath, int threads) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path too long.\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        perror("socket");
+        return -1;
+    }
+    // Replace a stale socket from an earlier run, but never any other file
+    struct stat st;
+    if (lstat(socketPath, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Error: '%s' exists and is not a socket.\n", socketPath);
+            close(listenFd);
+            return -1;
+        }
+        unlink(socketPath);
+    }
+    if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listenFd, SERVER_QUEUE_MAX) != 0) {
+        perror("bind/listen");
+        close(listenFd);
+        return -1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;     // no SA_RESTART: accept must return EINTR
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t tid;
+    for (int i = 0; i < threads; ++i) {
+        if (pthread_create(&tid, NULL, server_worker_main, NULL) != 0) {
+            perror("pthread_create");
+            return -1;
+        }
+        pthread_detach(tid);
+    }
+    if (pthread_create(&tid, NULL, committer_main, NULL) != 0) {
+        perror("pthread_create");
         return -1;
     }
-
-    printf("Student ID %d updated successfully.\n", studentID);
-    return 0;
+    pthread_detach(tid);
+
+    printf("Serving %zu records on %s with %d threads (durability %s). Ctrl-C to stop.\n",
+           live_count(), socketPath, threads, durabilityNames[durability]);
+    fflush(stdout);
+
+    while (!serverStopping) {
+        int fd = accept(listenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        pthread_mutex_lock(&queueLock);
+        while (queueCount == SERVER_QUEUE_MAX) pthread_cond_wait(&queueNotFull, &queueLock);
+        clientQueue[(queueHead + queueCount) % SERVER_QUEUE_MAX] = fd;
+        queueCount++;
+        pthread_cond_signal(&queueNotEmpty);
+        pthread_mutex_unlock(&queueLock);
+    }
+
+    close(listenFd);
+    unlink(socketPath);
+
+    // Hold the lock to the end so no worker touches the database again
+    pthread_mutex_lock(&commitLock);
+    serverDraining = 1;
+    pthread_cond_broadcast(&commitCond);
+    pthread_mutex_unlock(&commitLock);
+    pthread_rwlock_wrlock(&dbLock);
+    int rc = saveDatabase(DATAFILE);
+    printf("\nServer stopped; database %s to '%s'.\n", rc == 0 ? "saved" : "NOT saved", DATAFILE);
+    return rc;
+}
+
+// --- Load Generator ---
+// Opens `connections` client connections to a running server and issues a
+// read/write mix over ids each connection registered itself.
+typedef struct {
+    const char *socketPath;
+    int index;
+    long requests;
+    int readPercent;
+    long completed;
+    long failed;
+    double busySeconds;
+} LoadgenWorker;
+
+static int loadgen_call(int fd, const ServerRequest *req, ServerReply *reply) {
+    if (write_full(fd, req, sizeof(*req)) != 0 || read_full(fd, reply, sizeof(*reply)) != 0) return -1;
+    DiskRecord rec;
+    for (uint32_t i = 0; i < reply->count; ++i) {
+        if (read_full(fd, &rec, sizeof(rec)) != 0) return -1;
+    }
+    return 0;
+}
+
+static double seconds_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void *loadgen_main(void *arg) {
+    LoadgenWorker *w = arg;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, w->socketPath, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        if (fd >= 0) close(fd);
+        w->failed = w->requests;
+        return NULL;
+    }
+
+    unsigned seed = 12345u + (unsigned)w->index;
+    int base = 100000000 + w->index * 1000000;  // ids owned by this connection
+    int nextId = base;
+    ServerRequest req;
+    ServerReply reply;
+    Student s = createMockStudent(0);
+
+    for (int i = 0; i < LOADGEN_SEED_RECORDS; ++i) {
+        memset(&req, 0, sizeof(req));
+        req.op = REQ_REGISTER;
+        s.id = nextId++;
+        encode_record(&s, &req.record);
+        if (loadgen_call(fd, &req, &reply) != 0) break;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long n = 0; n < w->requests; ++n) {
+        memset(&req, 0, sizeof(req));
+        int roll = (int)(rand_r(&seed) % 100);
+        int span = nextId - base;
+        req.id = base + (span > 0 ? (int)(rand_r(&seed) % (unsigned)span) : 0);
+        if (roll < w->readPercent) {
+            if (rand_r(&seed) % 100 == 0) {
+                req.op = REQ_REPORT;
+                req.batch = (uint8_t)(rand_r(&seed) % NAME_COUNT(batchNames));
+                req.filter = ENUM_NONE;
+            } else {
+                req.op = REQ_LOOKUP;
+            }
+        } else {
+            int kind = (int)(rand_r(&seed) % 10);
+            if (kind < 5) {
+                req.op = REQ_UPDATE;
+                req.record.batch = (uint8_t)(rand_r(&seed) % NAME_COUNT(batchNames));
+                req.record.membership = ENUM_NONE;
+            } else if (kind < 9) {
+                req.op = REQ_REGISTER;
+                s.id = nextId++;
+                encode_record(&s, &req.record);
+            } else {
+                req.op = REQ_DELETE;
+            }
+        }
+        if (loadgen_call(fd, &req, &reply) != 0) {
+            w->failed += w->requests - n;
+            break;
+        }
+        // Not found and the like are normal here; a write the server could not commit is not
+        if (reply.status == DB_ERR_IO) w->failed++;
+        else w->completed++;
+    }
+    w->busySeconds = seconds_since(&start);
+    close(fd);
+    return NULL;
 }
 
-int deleteStudent(int studentID) {
-    long idx = findStudentIndexByID(studentID);
-    if (idx == -1) {
-        fprintf(stderr, "Student ID %d not found.\n", studentID);
+int runLoadGenerator(const char *socketPath, long requests, int connections, int readPercent) {
+    LoadgenWorker *workers = calloc((size_t)connections, sizeof(LoadgenWorker));
+    pthread_t *tids = calloc((size_t)connections, sizeof(pthread_t));
+    if (!workers || !tids) {
+        perror("calloc");
+        free(workers);
+        free(tids);
         return -1;
     }
 
-    for (size_t i = (size_t)idx; i + 1 < studentCount; ++i) {
-        students[i] = students[i+1];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < connections; ++i) {
+        workers[i].socketPath = socketPath;
+        workers[i].index = i;
+        workers[i].requests = requests / connections + (i < requests % connections);
+        workers[i].readPercent = readPercent;
     }
-    studentCount--;
-
-    // Optional: Shrink array capacity
-    if (studentCapacity > INITIAL_CAPACITY && studentCount * 4 < studentCapacity) {
-        size_t newCap = studentCapacity / 2;
-        if (newCap < INITIAL_CAPACITY) newCap = INITIAL_CAPACITY;
-        Student *tmp = realloc(students, newCap * sizeof(Student));
-        if (tmp) {
-            students = tmp;
-            studentCapacity = newCap;
+    int started = 0;
+    for (; started < connections; ++started) {
+        if (pthread_create(&tids[started], NULL, loadgen_main, &workers[started]) != 0) {
+            perror("pthread_create");
+            break;
         }
     }
-
-    if (saveDatabase(DATAFILE) != 0) {
-        fprintf(stderr, "Warning: deletion succeeded in memory but failed to save to disk.\n");
-        return -1;
+    long completed = 0, failed = 0;
+    double busy = 0;
+    // Requests of connections that never started count as failed
+    for (int i = started; i < connections; ++i) failed += workers[i].requests;
+    for (int i = 0; i < started; ++i) {
+        pthread_join(tids[i], NULL);
+        completed += workers[i].completed;
+        failed += workers[i].failed;
+        busy += workers[i].busySeconds;
     }
+    double elapsed = seconds_since(&start);
 
-    printf("Student ID %d deleted successfully.\n", studentID);
-    return 0;
+    printf("%ld requests (%d%% reads) over %d connections in %.3f s: %.0f requests/s, mean latency %.1f us",
+           completed, readPercent, connections, elapsed, completed / elapsed,
+           completed ? busy / completed * 1e6 : 0.0);
+    if (failed) printf(", %ld failed", failed);
+    printf("\n");
+    free(workers);
+    free(tids);
+    return failed ? -1 : 0;
 }
 
-void displayAllStudents(void) {
-    if (studentCount == 0) {
-        printf("No students found.\n");
-        return;
-    }
+// --- Crash Test ---
+// For each database size: build a base file, generate a fixed workload of
+// adds, updates and deletes (committed every CRASH_GROUP operations, with a
+// full save halfway), and run it once to count its I/O calls. Then, for
+// every one of those calls, restore the base, crash a child there, and load
+// what it left behind. Each recovered database must load, have a matching
+// id index and valid records, and equal the workload's state after some
+// prefix that includes every operation the child saw committed. Load time
+// is the recovery time.
+enum { CRASH_ADD, CRASH_UPDATE, CRASH_DELETE };
+
+typedef struct {
+    int kind;
+    Student rec;                // CRASH_UPDATE uses id, batch and membership; CRASH_DELETE only id
+} CrashOp;
+
+typedef struct {
+    size_t records;
+    size_t points, recovered, loadFailed, inconsistent, lostCommitted, unrecognised, damageReported;
+    double cleanLoadMs, recoveryMsTotal, recoveryMsMax;
+} CrashSizeResult;
+
+// Order-independent digest of the live records: a sum of per-record FNV-1a 64 hashes
+static uint64_t record_digest(const Student *s) {
+    DiskRecord rec;
+    encode_record(s, &rec);
+    const unsigned char *p = (const unsigned char *)&rec;
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < sizeof(rec); ++i) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+static uint64_t state_digest(void) {
+    uint64_t d = 0;
     for (size_t i = 0; i < studentCount; ++i) {
-        printf("---- Record %zu ----", i+1);
-        printStudent(&students[i]);
+        if (!is_tombstone(student_at(i))) d += record_digest(student_at(i));
     }
+    return d;
 }
 
-void generateBatchReport(const char *batchFilter, const char *membershipFilter) {
-    int found = 0;
-    
-    if (!validBatch(batchFilter)) {
-        fprintf(stderr, "Invalid batch filter: %s\n", batchFilter);
-        return;
-    }
-    
-    if (strlen(membershipFilter) > 0 && !validInterest(membershipFilter)) {
-        fprintf(stderr, "Invalid membership filter: %s (Must be IEEE, ACM, or Both)\n", membershipFilter);
-        return;
+static int state_consistent(void) {
+    for (size_t i = 0; i < studentCount; ++i) {
+        if (is_tombstone(student_at(i))) continue;
+        if (!valid_student(student_at(i)) || findStudentIndexByID(student_at(i)->id) != (long)i) return 0;
     }
+    return idIndexCount == live_count();
+}
 
-    printf("\n--- Batch Report (Batch: %s, Filter: %s) ---\n", 
-           batchFilter, 
-           strlen(membershipFilter) == 0 ? "Any" : membershipFilter);
-
-    for (size_t i = 0; i < studentCount; ++i) {
-        const Student *s = &students[i];
-        
-        if (strcmp(s->batch, batchFilter) != 0) continue;
-        
-        int membershipMatch = 0;
-        if (strlen(membershipFilter) == 0) {
-            membershipMatch = 1; 
-        } else if (strcmp(membershipFilter, "Both") == 0) {
-            if (strcmp(s->interest, "Both") == 0) membershipMatch = 1;
-        } else {
-            // Check if student's current membership or interest includes the filter
-            if (strcmp(s->membership, membershipFilter) == 0 || strcmp(s->interest, membershipFilter) == 0 || strcmp(s->interest, "Both") == 0) {
-                membershipMatch = 1;
-            }
-        }
-        
-        if (membershipMatch) {
-            printStudent(s);
-            found = 1;
+static int copy_file(const char *from, const char *to) {
+    int in = open(from, O_RDONLY);
+    int out = in < 0 ? -1 : open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    char buf[1 << 16];
+    ssize_t n = 0;
+    while (out >= 0 && (n = read(in, buf, sizeof(buf))) > 0) {
+        if (write_full(out, buf, (size_t)n) != 0) {
+            n = -1;
+            break;
         }
     }
-    if (!found) {
-        printf("No records matching the specified criteria.\n");
-    }
-    printf("---------------------------------------------\n");
+    if (in >= 0) close(in);
+    if (out >= 0 && close(out) != 0) n = -1;
+    return in < 0 || out < 0 || n < 0 ? -1 : 0;
 }
 
+// Drops the journal, temp file, redo log and id index a previous run left
+static void crash_clear(void) {
+    char path[512];
+    journal_path(DATAFILE, path, sizeof(path));
+    remove(path);
+    snprintf(path, sizeof(path), "%s.tmp", DATAFILE);
+    remove(path);
+    redo_path(DATAFILE, path, sizeof(path));
+    remove(path);
+    idx_path(DATAFILE, path, sizeof(path));
+    remove(path);
+}
 
-// Function for interactive registration with robust input loops
-void registerStudentInteractive(void) {
-    Student s;
-    int tmp_id;
+// Puts the base files back over whatever a previous run left
+static int crash_restore(void) {
+    char path[512], base[sizeof(path) + 8];
+    crash_clear();
+    idx_path(DATAFILE, path, sizeof(path));
+    snprintf(base, sizeof(base), "%s.base", path);
+    if (access(base, F_OK) == 0 && copy_file(base, path) != 0) return -1;
+    snprintf(path, sizeof(path), "%s.base", DATAFILE);
+    return copy_file(path, DATAFILE);
+}
 
-    printf("\n--- New Student Registration ---\n");
-    printf("Enter Student ID (integer): ");
-    
-    // Use scanf for ID, then aggressively clear the input buffer
-    if (scanf("%d", &tmp_id) != 1) {
-        fprintf(stderr, "Invalid ID input. Registration aborted.\n");
-        int c; while ((c = getchar()) != '\n' && c != EOF); 
-        return;
+// Points fd at /dev/null; returns a copy of the old target for unsilence
+static int silence(int fd) {
+    fflush(fd == STDOUT_FILENO ? stdout : stderr);
+    int saved = dup(fd);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull >= 0) {
+        dup2(devNull, fd);
+        close(devNull);
     }
-    s.id = tmp_id;
-    int c; while ((c = getchar()) != '\n' && c != EOF); // Clear buffer after scanf
-    // Optional: Add a non-standard but often effective extra clear
-    fflush(stdin); 
+    return saved;
+}
 
-    if (findStudentIndexByID(s.id) != -1) {
-        fprintf(stderr, "Error: Student with ID %d already exists.\n", s.id);
-        return;
-    }
+static void unsilence(int fd, int saved) {
+    fflush(fd == STDOUT_FILENO ? stdout : stderr);
+    if (saved < 0) return;
+    dup2(saved, fd);
+    close(saved);
+}
 
-    char input_buffer[NAME_LEN];
-    int valid = 0;
+// Loads the database with warnings silenced; returns loadDatabase's result and the time taken
+static int crash_load(double *ms) {
+    forget_database();
+    ensure_capacity(INITIAL_CAPACITY);
+    int savedErr = silence(STDERR_FILENO);
+    uint64_t start = bench_now_ns();
+    int rc = loadDatabase(DATAFILE);
+    *ms = (bench_now_ns() - start) / 1e6;
+    unsilence(STDERR_FILENO, savedErr);
+    return rc;
+}
 
-    // 1. Full Name (NOW IN ROBUST LOOP to prevent skips)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Full Name: ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Full Name cannot be empty. Try again.\n");
-            continue;
-        }
-        strncpy(s.name, input_buffer, sizeof(s.name) - 1);
-        s.name[sizeof(s.name) - 1] = '\0';
-        valid = 1;
+// Opens the loaded file paged and checks that its id index (trusted or
+// rebuilt) puts every loaded record at its slot; messages are silenced
+static int crash_paged_consistent(void) {
+    int savedOut = silence(STDOUT_FILENO), savedErr = silence(STDERR_FILENO);
+    int ok = paged_open(DATAFILE, pagedPoolPages) == 0;
+    ok = ok && pagedCount == studentCount && pagedLive == studentCount - freeSlotCount;
+    for (size_t i = 0; ok && i < studentCount; ++i) {
+        if (!is_tombstone(student_at(i))) ok = idx_find(student_at(i)->id) == (long)i;
     }
-    
-    // 2. Batch (Input loop ensures valid selection)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Batch (CS / SE / Cyber Security / AI): ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Batch cannot be empty. Try again.\n");
-            continue;
-        }
-        if (!validBatch(input_buffer)) { fprintf(stderr, "Invalid batch. Try again.\n"); continue; }
-        strncpy(s.batch, input_buffer, sizeof(s.batch) - 1);
-        s.batch[sizeof(s.batch) - 1] = '\0';
-        valid = 1;
+    if (storageMode == STORAGE_PAGED) {
+        pool_free();
+        inplace_close();
+        storageMode = STORAGE_JOURNAL;
     }
+    unsilence(STDOUT_FILENO, savedOut);
+    unsilence(STDERR_FILENO, savedErr);
+    return ok;
+}
 
-    // 3. Membership (Input loop ensures valid selection)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Membership (IEEE / ACM): ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Membership cannot be empty. Try again.\n");
-            continue;
-        }
-        if (!validMembership(input_buffer)) { fprintf(stderr, "Invalid membership. Try again.\n"); continue; }
-        strncpy(s.membership, input_buffer, sizeof(s.membership) - 1);
-        s.membership[sizeof(s.membership) - 1] = '\0';
-        valid = 1;
+// Builds the workload against the loaded base with in-memory changes only,
+// recording the state digest after every prefix
+static CrashOp *crash_workload(size_t count, uint64_t *digests) {
+    CrashOp *ops = malloc((count ? count : 1) * sizeof(CrashOp));
+    if (!ops) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
     }
-
-    // 4. Registration Date (Input loop ensures valid YYYY-MM-DD date)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Registration Date (YYYY-MM-DD): ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Registration Date cannot be empty. Try again.\n");
-            continue;
-        }
-        if (!validDateFormat(input_buffer)) { 
-            fprintf(stderr, "Invalid date format or non-existent date (e.g., Feb 30th). Required: YYYY-MM-DD. Try again.\n"); 
-            continue; 
-        }
-        strncpy(s.regDate, input_buffer, sizeof(s.regDate) - 1);
-        s.regDate[sizeof(s.regDate) - 1] = '\0';
-        valid = 1;
+    int nextId = 1;
+    for (size_t i = 0; i < studentCount; ++i) {
+        if (!is_tombstone(student_at(i)) && student_at(i)->id >= nextId) nextId = student_at(i)->id + 1;
     }
-    
-    // 5. Date of Birth (Input loop ensures valid YYYY-MM-DD date)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Date of Birth (YYYY-MM-DD): ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Date of Birth cannot be empty. Try again.\n");
-            continue; // Loop again until valid input is given
+    digests[0] = state_digest();
+    for (size_t n = 0; n < count; ++n) {
+        CrashOp *op = &ops[n];
+        int roll = rand() % 10;
+        op->kind = live_count() == 0 || roll < 3 ? CRASH_ADD : roll < 8 ? CRASH_UPDATE : CRASH_DELETE;
+        size_t idx = 0;
+        if (op->kind != CRASH_ADD) {
+            do idx = (size_t)rand() % studentCount; while (is_tombstone(student_at(idx)));
         }
-        if (!validDateFormat(input_buffer)) { 
-            fprintf(stderr, "Invalid date format or non-existent date (e.g., Feb 30th). Required: YYYY-MM-DD. Try again.\n"); 
-            continue; 
+        uint64_t d = digests[n];
+        if (op->kind == CRASH_ADD) {
+            op->rec = createMockStudent(nextId++);
+            put_in_memory(&op->rec);
+            d += record_digest(&op->rec);
+        } else if (op->kind == CRASH_UPDATE) {
+            op->rec = *student_at(idx);
+            strcpy(op->rec.batch, batchNames[rand() % NAME_COUNT(batchNames)]);
+            strcpy(op->rec.membership, membershipNames[rand() % NAME_COUNT(membershipNames)]);
+            d += record_digest(&op->rec) - record_digest(student_at(idx));
+            put_in_memory(&op->rec);
+        } else {
+            op->rec = *student_at(idx);
+            d -= record_digest(student_at(idx));
+            remove_in_memory(idx);
         }
-        strncpy(s.dob, input_buffer, sizeof(s.dob) - 1);
-        s.dob[sizeof(s.dob) - 1] = '\0';
-        valid = 1;
+        digests[n + 1] = d;
     }
+    return ops;
+}
 
-    // 6. Interest (Input loop ensures valid selection)
-    valid = 0;
-    while(!valid) {
-        read_line_input("Interest (IEEE / ACM / Both): ", input_buffer, sizeof(input_buffer));
-        if (strlen(input_buffer) == 0) { 
-            fprintf(stderr, "Interest cannot be empty. Try again.\n");
-            continue;
-        }
-        if (!validInterest(input_buffer)) { fprintf(stderr, "Invalid interest option. Try again.\n"); continue; }
-        strncpy(s.interest, input_buffer, sizeof(s.interest) - 1);
-        s.interest[sizeof(s.interest) - 1] = '\0';
-        valid = 1;
+// Child side: load, run the workload and report each committed prefix on ackFd.
+// A run that finishes also sends UINT32_MAX and the number of I/O calls it made.
+static void crash_child(const CrashOp *ops, size_t count, int storage, long crashAt, int ackFd) {
+    silence(STDOUT_FILENO);
+    silence(STDERR_FILENO);
+    if (storage == STORAGE_PAGED) {
+        if (paged_open(DATAFILE, pagedPoolPages) != 0) _exit(EXIT_FAILURE);
+    } else {
+        double ms;
+        if (crash_load(&ms) != 0 || (storage == STORAGE_INPLACE && inplace_open(DATAFILE) != 0)) _exit(EXIT_FAILURE);
     }
 
-    if (addStudent(&s, DATAFILE) == 0) {
-        printf("Student ID %d registered successfully.\n", s.id);
-    } else {
-        fprintf(stderr, "Failed to register student.\n");
+    faultCalls = 0;
+    faultAt = crashAt;
+    int saved = 0;
+    for (size_t i = 0; i < count; ) {
+        beginBatch();
+        for (size_t end = i + CRASH_GROUP < count ? i + CRASH_GROUP : count; i < end; ++i) {
+            const CrashOp *op = &ops[i];
+            if (op->kind == CRASH_ADD) db_add(&op->rec);
+            else if (op->kind == CRASH_UPDATE) db_update(op->rec.id, op->rec.batch, op->rec.membership);
+            else db_delete(op->rec.id);
+        }
+        uint32_t acked = (uint32_t)i;
+        if (commitBatch() == 0) write_full(ackFd, &acked, sizeof(acked));
+        if (!saved && i >= count / 2) {
+            saved = 1;
+            if (saveDatabase(DATAFILE) == 0) write_full(ackFd, &acked, sizeof(acked));
+        }
     }
+    uint32_t done[2] = { UINT32_MAX, (uint32_t)faultCalls };
+    write_full(ackFd, done, sizeof(done));
+    _exit(EXIT_SUCCESS);
 }
 
-
-static Student createMockStudent(int id) {
-    static const char *names[] = {"Aamir Khan", "Sara Ali", "Usman Tariq", "Javeria Nasir", "Zainab Raza", "Tariq Ali", "Ayesha Ahmed"};
-    static const char *batches[] = {"CS", "SE", "Cyber Security", "AI"};
-    static const char *memberships[] = {"IEEE", "ACM"};
-    static const char *interests[] = {"IEEE", "ACM", "Both"};
-
-    Student s;
-    s.id = id;
-    
-    strncpy(s.name, names[rand() % (sizeof(names) / sizeof(names[0]))], NAME_LEN - 1);
-    s.name[NAME_LEN - 1] = '\0';
-    strncpy(s.batch, batches[rand() % (sizeof(batches) / sizeof(batches[0]))], 31);
-    s.batch[31] = '\0';
-    strncpy(s.membership, memberships[rand() % (sizeof(memberships) / sizeof(memberships[0]))], 7);
-    s.membership[7] = '\0';
-    strncpy(s.interest, interests[rand() % (sizeof(interests) / sizeof(interests[0]))], 7);
-    s.interest[7] = '\0';
-
-    snprintf(s.regDate, DATE_LEN, "2024-09-%02d", (rand() % 30) + 1);
-    snprintf(s.dob, DATE_LEN, "2000-01-%02d", (rand() % 28) + 1);
-
-    return s;
+// Runs one child; returns the last committed prefix and, for a complete run, its I/O call count
+static int crash_run(const CrashOp *ops, size_t count, int storage, long crashAt, size_t *acked, long *calls) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return -1;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        crash_child(ops, count, storage, crashAt, fds[1]);
+    }
+    close(fds[1]);
+    uint32_t v;
+    int sawEnd = 0;
+    *acked = 0;
+    while (read_full(fds[0], &v, sizeof(v)) == 0) {
+        if (sawEnd) *calls = v;
+        else if (v == UINT32_MAX) sawEnd = 1;
+        else *acked = v;
+    }
+    close(fds[0]);
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) return -1;
+    int code = WEXITSTATUS(status);
+    return code == FAULT_EXIT || (code == EXIT_SUCCESS && sawEnd) ? 0 : -1;
 }
 
-void runStressTest(void) {
-    srand(time(NULL)); 
-    const int initial_id = 9000;
-    
-    printf("\n--- Running Stress Test (Task 5) ---\n");
-    size_t initial_count = studentCount;
-
-    // 1. Add 20–30 student records
-    int count_to_add = (rand() % 11) + 20; 
-    printf("1. Adding %d mock records...\n", count_to_add);
-    for (int i = 0; i < count_to_add; ++i) {
-        int id = initial_id + i;
-        Student s = createMockStudent(id);
-        addStudent(&s, DATAFILE);
-    }
-    printf("   -> Added %zu records. Total records: %zu.\n", studentCount - initial_count, studentCount);
-
-    // 2. Delete 5–10 random students.
-    int count_to_delete = (rand() % 6) + 5; 
-    printf("2. Deleting %d random mock records...\n", count_to_delete);
-    
-    for (int i = 0; i < count_to_delete; ++i) {
-        if (studentCount == 0) break;
-        
-        size_t index_to_delete = rand() % studentCount;
-        int id_to_delete = students[index_to_delete].id;
+static int crash_test_size(size_t records, size_t opCount, int storage, CrashSizeResult *res) {
+    memset(res, 0, sizeof(*res));
+    res->records = records;
 
-        deleteStudent(id_to_delete); 
+    // Base file: `records` mock students, saved and kept aside; the last size's files go first
+    double ms;
+    crash_clear();
+    remove(DATAFILE);
+    forget_database();
+    ensure_capacity(INITIAL_CAPACITY);
+    if (loadDatabase(DATAFILE) != 0) return -1;
+    Student *chunk = malloc(BENCH_PRELOAD_CHUNK * sizeof(Student));
+    if (!chunk) {
+        perror("malloc");
+        return -1;
+    }
+    beginBatch();
+    for (size_t done = 0; done < records; ) {
+        size_t n = records - done < BENCH_PRELOAD_CHUNK ? records - done : BENCH_PRELOAD_CHUNK;
+        for (size_t i = 0; i < n; ++i) chunk[i] = createMockStudent((int)(done + i) + 1);
+        addStudents(chunk, n);
+        done += n;
+    }
+    commitBatch();
+    free(chunk);
+    char path[512], basePath[sizeof(path) + 8];
+    snprintf(basePath, sizeof(basePath), "%s.base", DATAFILE);
+    if (saveDatabase(DATAFILE) != 0 || copy_file(DATAFILE, basePath) != 0) return -1;
+    if (storage == STORAGE_PAGED) {
+        // A checkpointed index goes with the base, so children start from a trusted one
+        idx_path(DATAFILE, path, sizeof(path));
+        snprintf(basePath, sizeof(basePath), "%s.base", path);
+        if (!crash_paged_consistent() || copy_file(path, basePath) != 0) return -1;
     }
-    printf("   -> Deleted records. Total records: %zu.\n", studentCount);
 
-    // 3. Update 5 random records.
-    int count_to_update = 5;
-    printf("3. Updating %d random records...\n", count_to_update);
-    
-    const char *new_batch = "AI";
-    const char *new_membership = "ACM";
-
-    for (int i = 0; i < count_to_update; ++i) {
-        if (studentCount == 0) break;
-        
-        size_t index_to_update = rand() % studentCount;
-        Student *s = &students[index_to_update];
-        
-        // Ensure values are changed
-        if (strcmp(s->batch, "AI") != 0) {
-             strncpy(s->batch, new_batch, sizeof(s->batch));
-        } else {
-             strncpy(s->batch, "CS", sizeof(s->batch));
+    uint64_t *digests = malloc((opCount + 1) * sizeof(uint64_t));
+    if (!digests || crash_load(&res->cleanLoadMs) != 0) {
+        free(digests);
+        return -1;
+    }
+    CrashOp *ops = crash_workload(opCount, digests);
+
+    size_t acked;
+    long calls = 0;
+    int rc = crash_restore() == 0 ? crash_run(ops, opCount, storage, 0, &acked, &calls) : -1;
+    for (long at = 1; rc == 0 && at <= calls; ++at) {
+        if (crash_restore() != 0 || crash_run(ops, opCount, storage, at, &acked, &calls) != 0) {
+            rc = -1;
+            break;
         }
+        res->points++;
+        int loaded = crash_load(&ms) == 0;
+        res->recoveryMsTotal += ms;
+        if (ms > res->recoveryMsMax) res->recoveryMsMax = ms;
+        res->damageReported += baseDamaged != 0;
 
-        if (strcmp(s->membership, "ACM") != 0) {
-            strncpy(s->membership, new_membership, sizeof(s->membership));
+        const char *failure = NULL;
+        if (!loaded) {
+            res->loadFailed++;
+            failure = "load failed";
+        } else if (!state_consistent() || (storage == STORAGE_PAGED && !crash_paged_consistent())) {
+            res->inconsistent++;
+            failure = "inconsistent records or index";
         } else {
-             strncpy(s->membership, "IEEE", sizeof(s->membership));
+            // Recovered means some prefix at least as long as the committed one
+            uint64_t d = state_digest();
+            size_t j = acked;
+            while (j <= opCount && digests[j] != d) j++;
+            size_t shorter = 0;
+            while (shorter < acked && digests[shorter] != d) shorter++;
+            if (j <= opCount) {
+                res->recovered++;
+            } else if (shorter < acked) {
+                res->lostCommitted++;
+                failure = "lost committed operations";
+            } else {
+                res->unrecognised++;
+                failure = "state matches no prefix of the workload";
+            }
         }
-        
-        // Note: The original logic in updateStudent saves the database. Here we save manually.
-        saveDatabase(DATAFILE); 
+        if (failure) {
+            fprintf(stderr, "  %zu records, crash at I/O call %ld (committed through op %zu): %s\n",
+                    records, at, acked, failure);
+        }
+    }
+    free(ops);
+    free(digests);
+    forget_database();
+    return rc;
+}
+
+// Runs the crash test for 1000, 10000, ... up to `records` records and writes JSON results
+int runCrashTest(unsigned seed, size_t records, size_t opCount, int storage, const char *output) {
+    static const char *const deleteModeNames[] = { "shift", "swap", "tombstone" };
+    static const char *const storageNames[] = { "journal", "inplace", "paged" };
+    FILE *out = strcmp(output, "-") == 0 ? stdout : fopen(output, "w");
+    if (!out) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for crash test results.\n", output);
+        return -1;
+    }
+    char dir[] = "members-crash-XXXXXX";
+    if (scratch_enter(dir) != 0) {
+        if (out != stdout) fclose(out);
+        return -1;
     }
-    printf("   -> Updated and saved %d records.\n", count_to_update);
 
-    // 4. Verify that file integrity is maintained 
-    printf("4. Verifying file integrity...\n");
-    
-    size_t temp_count = 0;
-    FILE *f_test = fopen(DATAFILE, "rb");
-    if (f_test) {
-        Student tmp;
-        while (fread(&tmp, sizeof(Student), 1, f_test) == 1) temp_count++;
-        fclose(f_test);
+    srand(seed);
+    CrashSizeResult results[16];
+    size_t sizes = 0;
+    int rc = 0, passed = 1;
+    for (size_t n = records < 1000 ? records : 1000; rc == 0 && sizes < 16; n *= 10) {
+        if (n > records) n = records;
+        fprintf(stderr, "Crash test: %zu records, %zu operations...\n", n, opCount);
+        rc = crash_test_size(n, opCount, storage, &results[sizes]);
+        CrashSizeResult *r = &results[sizes++];
+        passed = passed && rc == 0 && r->recovered == r->points;
+        if (n == records || n == 0) break;
     }
 
-    if (temp_count == studentCount) {
-        printf("   -> Verification SUCCEEDED: Memory count (%zu) matches File count (%zu).\n", studentCount, temp_count);
+    fprintf(out, "{\n  \"seed\": %u,\n  \"ops\": %zu,\n  \"storage\": \"%s\",\n  \"delete_mode\": \"%s\",\n"
+                 "  \"durability\": \"%s\",\n  \"sizes\": [\n",
+            seed, opCount, storageNames[storage], deleteModeNames[deleteMode], durabilityNames[durability]);
+    for (size_t i = 0; i < sizes; ++i) {
+        const CrashSizeResult *r = &results[i];
+        fprintf(out, "    {\"records\": %zu, \"crash_points\": %zu, \"recovered\": %zu, \"load_failed\": %zu, "
+                     "\"inconsistent\": %zu, \"lost_committed\": %zu, \"unrecognised\": %zu, "
+                     "\"damage_reported\": %zu, \"clean_load_ms\": %.3f, \"recovery_ms_mean\": %.3f, "
+                     "\"recovery_ms_max\": %.3f}%s\n",
+                r->records, r->points, r->recovered, r->loadFailed, r->inconsistent, r->lostCommitted,
+                r->unrecognised, r->damageReported, r->cleanLoadMs,
+                r->points ? r->recoveryMsTotal / r->points : 0.0, r->recoveryMsMax, i + 1 < sizes ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"passed\": %s\n}\n", passed ? "true" : "false");
+    if (out != stdout) {
+        if (fclose(out) != 0) rc = -1;
     } else {
-        printf("   -> Verification FAILED: Memory count (%zu) DOES NOT match File count (%zu).\n", studentCount, temp_count);
+        fflush(stdout);
     }
-    printf("--- Stress Test Complete ---\n");
+    scratch_leave(dir);
+    return rc == 0 && passed ? 0 : -1;
 }
 
-
+#ifndef PF_LIBRARY
 void printMenu(void) {
     puts("\n--- FAST University Membership System ---");
     puts("1. Register new student");
@@ -597,27 +4462,210 @@ void printMenu(void) {
     puts("3. Delete a student");
     puts("4. View all registrations");
     puts("5. Generate batch-wise report");
-    puts("6. Run Stress Test (Add, Delete, Update Mock Data)");
+    puts("6. Run benchmark on mock data (JSON results; -B for options)");
     puts("7. Exit");
+    puts("8. Compact database file (journal and deleted slots)");
+    puts("9. List students registered within a date range");
+    puts("10. List students born within a date range");
+    puts("11. Bulk-register mock students (batched)");
+    puts("12. Import students from a CSV file");
+    puts("13. Export students to a CSV file");
     printf("Enter choice: ");
 }
 
-int main(void) {
-    students = NULL;
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-i | -P pages] [-d shift|swap|tombstone] [-D none|group|sync] [-W ms] [-S socket [-T threads]]\n", prog);
+    fprintf(stderr, "       %s -L socket [-n requests] [-c connections] [-r read%%]\n", prog);
+    fprintf(stderr, "       %s [-I import.csv] [-E export.csv]\n", prog);
+    fprintf(stderr, "       %s -B results.json [-s seed] [-n records] [-o ops] [-m mix] [-k keys]\n", prog);
+    fprintf(stderr, "       %s -F results.json [-i | -P pages] [-s seed] [-n records] [-o ops]\n", prog);
+    fprintf(stderr, "  -i  update members.dat in place (pwrite + fdatasync) instead of journaling\n");
+    fprintf(stderr, "  -P  paged: keep members.dat on disk behind a buffer pool of this many %d-byte\n", POOL_PAGE_SIZE);
+    fprintf(stderr, "      pages (at least %d, default %d) and an on-disk id index; deletes swap\n", POOL_MIN_PAGES, POOL_DEFAULT_PAGES);
+    fprintf(stderr, "  -d  delete by shifting later records (default), swapping in the last one,\n");
+    fprintf(stderr, "      or leaving a tombstone whose slot the next registration reuses\n");
+    fprintf(stderr, "  -D  durability: none (no fsync), group (one fdatasync per commit) or\n");
+    fprintf(stderr, "      sync (fdatasync per record); default none, or sync with -i\n");
+    fprintf(stderr, "  -W  commit window in milliseconds for pending writes (default %d)\n", GROUP_COMMIT_WINDOW_MS);
+    fprintf(stderr, "  -S  serve the database on a Unix socket instead of the menu\n");
+    fprintf(stderr, "  -T  server worker threads (default %d)\n", SERVER_DEFAULT_THREADS);
+    fprintf(stderr, "  -L  run the load generator against a server on this socket:\n");
+    fprintf(stderr, "      -n requests (default 100000), -c connections (default 4),\n");
+    fprintf(stderr, "      -r read percentage (default 90)\n");
+    fprintf(stderr, "  -B  benchmark on mock data in a scratch directory, JSON to the file (- for stdout):\n");
+    fprintf(stderr, "      -s seed (default 1), -n preloaded records and -o timed operations\n");
+    fprintf(stderr, "      (default 100000 each), -m weights such as add=10,update=20,delete=5,\n");
+    fprintf(stderr, "      lookup=60,report=5 (the default), -k uniform|zipf|latest keys\n");
+    fprintf(stderr, "  -F  crash test in a scratch directory: crash at every file write, sync,\n");
+    fprintf(stderr, "      rename and removal of a workload of -o ops (default 64) over 1000,\n");
+    fprintf(stderr, "      10000, ... up to -n records (default 10000), then check recovery\n");
+    fprintf(stderr, "  -I  import a CSV file (id,name,batch,membership,regDate,dob,interest) and exit\n");
+    fprintf(stderr, "  -E  export every record to a CSV file and exit (after any -I)\n");
+}
+
+int main(int argc, char **argv) {
+    int inPlace = 0, paged = 0;
+    int durabilityLevel = -1;
+    const char *serverSocket = NULL, *loadgenSocket = NULL;
+    int serverThreads = SERVER_DEFAULT_THREADS;
+    long count = 100000;            // -n: load generator requests, benchmark or crash test records
+    int countGiven = 0;
+    const char *benchOutput = NULL, *crashOutput = NULL;
+    BenchConfig bench = benchDefaults;
+    long benchOps = -1;
+    int loadgenConnections = 4, loadgenReadPercent = 90;
+    const char *importPath = NULL, *exportPath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-i") == 0) {
+            inPlace = 1;
+        } else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc) {
+            long pages = atol(argv[++i]);
+            if (pages < POOL_MIN_PAGES) { usage(argv[0]); return EXIT_FAILURE; }
+            pagedPoolPages = (size_t)pages;
+            paged = 1;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "shift") == 0) deleteMode = DELETE_SHIFT;
+            else if (strcmp(mode, "swap") == 0) deleteMode = DELETE_SWAP;
+            else if (strcmp(mode, "tombstone") == 0) deleteMode = DELETE_TOMBSTONE;
+            else { usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-D") == 0 && i + 1 < argc) {
+            const char *level = argv[++i];
+            durabilityLevel = -1;
+            for (int d = 0; d < (int)NAME_COUNT(durabilityNames); ++d) {
+                if (strcmp(level, durabilityNames[d]) == 0) durabilityLevel = d;
+            }
+            if (durabilityLevel < 0) { usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-W") == 0 && i + 1 < argc) {
+            commitWindowMs = strtol(argv[++i], NULL, 10);
+            if (commitWindowMs < 0) { usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+            serverSocket = argv[++i];
+        } else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+            serverThreads = atoi(argv[++i]);
+            if (serverThreads < 1 || serverThreads > SERVER_MAX_THREADS) { usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+            loadgenSocket = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = atol(argv[++i]);
+            countGiven = 1;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            loadgenConnections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            loadgenReadPercent = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-I") == 0 && i + 1 < argc) {
+            importPath = argv[++i];
+        } else if (strcmp(argv[i], "-E") == 0 && i + 1 < argc) {
+            exportPath = argv[++i];
+        } else if (strcmp(argv[i], "-B") == 0 && i + 1 < argc) {
+            benchOutput = argv[++i];
+        } else if (strcmp(argv[i], "-F") == 0 && i + 1 < argc) {
+            crashOutput = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            bench.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            benchOps = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            if (parse_mix(argv[++i], bench.mix) != 0) { usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            const char *keys = argv[++i];
+            if (strcmp(keys, "uniform") == 0) bench.keys = KEYS_UNIFORM;
+            else if (strcmp(keys, "zipf") == 0) bench.keys = KEYS_ZIPF;
+            else if (strcmp(keys, "latest") == 0) bench.keys = KEYS_LATEST;
+            else { usage(argv[0]); return EXIT_FAILURE; }
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Paged mode has no in-memory table for the server or the benchmark to share
+    if (paged && (inPlace || serverSocket || benchOutput)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // In-place and paged writes were always fdatasynced; the journal was never synced
+    durability = durabilityLevel >= 0 ? durabilityLevel : inPlace || paged ? DURABILITY_SYNC : DURABILITY_NONE;
+
+    // The load generator is only a client; it never opens members.dat
+    if (loadgenSocket) {
+        if (count < 1 || loadgenConnections < 1 || loadgenReadPercent < 0 || loadgenReadPercent > 100) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return runLoadGenerator(loadgenSocket, count, loadgenConnections, loadgenReadPercent) == 0
+               ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // The benchmark builds its own database in a scratch directory
+    if (benchOutput) {
+        if (count < 0 || benchOps < -1) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        bench.records = (size_t)count;
+        bench.ops = benchOps >= 0 ? (size_t)benchOps : (size_t)count;
+        bench.inPlace = inPlace;
+        bench.output = benchOutput;
+        return runBenchmark(&bench) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // So does the crash test; every crash point costs a fork and a reload, hence the smaller defaults
+    if (crashOutput) {
+        if (count < 0 || benchOps < -1) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return runCrashTest(bench.seed, countGiven ? (size_t)count : 10000, benchOps >= 0 ? (size_t)benchOps : 64,
+                            paged ? STORAGE_PAGED : inPlace ? STORAGE_INPLACE : STORAGE_JOURNAL,
+                            crashOutput) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     studentCount = 0;
-    studentCapacity = 0;
     ensure_capacity(INITIAL_CAPACITY);
+    indexes_rebuild();
     
     printf("\nInitializing FAST University Membership Manager...\n");
 
-    if (loadDatabase(DATAFILE) != 0) {
+    if (paged) {
+        if (paged_open(DATAFILE, pagedPoolPages) != 0) {
+            fprintf(stderr, "Error: could not open '%s' in paged mode.\n", DATAFILE);
+            return EXIT_FAILURE;
+        }
+        printf("Paged storage mode: %zu records in '%s', %zu pool pages.\n", live_count(), DATAFILE, poolPages);
+    } else if (loadDatabase(DATAFILE) != 0) {
         fprintf(stderr, "Warning: could not load database file '%s'. Starting with empty DB.\n", DATAFILE);
     } else {
-        printf("Successfully loaded %zu existing records from '%s'.\n", studentCount, DATAFILE);
+        printf("Successfully loaded %zu existing records from '%s'.\n", live_count(), DATAFILE);
+    }
+
+    if (inPlace) {
+        if (inplace_open(DATAFILE) != 0) {
+            fprintf(stderr, "Warning: in-place mode unavailable, falling back to the journal.\n");
+        } else {
+            printf("In-place storage mode: records are rewritten at their file offset.\n");
+        }
+    }
+
+    // Shift and swap deletes assume every slot is live
+    if (deleteMode != DELETE_TOMBSTONE && freeSlotCount > 0 && tombstone_compact(DATAFILE) != 0) {
+        fprintf(stderr, "Warning: could not compact deleted slots left by tombstone mode.\n");
     }
 
+    if (serverSocket) {
+        return runServer(serverSocket, serverThreads) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // -I and -E run without the menu
+    int exitCode = EXIT_SUCCESS;
+    if (importPath && importCSV(importPath) < 0) exitCode = EXIT_FAILURE;
+    if (exportPath && exportCSV(exportPath) != 0) exitCode = EXIT_FAILURE;
+    if ((importPath || exportPath) && commitWrites() != 0) exitCode = EXIT_FAILURE;
+    if ((importPath || exportPath) && paged_close() != 0) exitCode = EXIT_FAILURE;
+
     int choice = 0;
-    while (1) {
+    while (!importPath && !exportPath) {
         printMenu();
         if (scanf("%d", &choice) != 1) {
             fprintf(stderr, "Invalid choice input. Please enter a number.\n");
@@ -646,7 +4694,9 @@ int main(void) {
             read_line_input("Membership filter (IEEE / ACM / Both) or press Enter for any interest: ", membership, sizeof(membership));
             generateBatchReport(batch, membership);
         } else if (choice == 6) { 
-            runStressTest();
+            BenchConfig cfg = benchDefaults;
+            cfg.inPlace = storageMode == STORAGE_INPLACE;
+            if (runBenchmarkDetached(&cfg) != 0) fprintf(stderr, "Benchmark failed.\n");
         } else if (choice == 7) { 
             if (saveDatabase(DATAFILE) != 0) {
                 fprintf(stderr, "Error: failed to save database before exit. Exiting anyway.\n");
@@ -654,15 +4704,41 @@ int main(void) {
                 printf("Database saved to '%s'.\n", DATAFILE);
             }
             break;
+        } else if (choice == 8) {
+            if (saveDatabase(DATAFILE) != 0) {
+                fprintf(stderr, "Error: compaction failed.\n");
+            } else {
+                printf("Database compacted into '%s'.\n", DATAFILE);
+            }
+        } else if (choice == 9 || choice == 10) {
+            char from[32], to[32];
+            read_line_input("From date (YYYY-MM-DD) or press Enter for no lower bound: ", from, sizeof(from));
+            read_line_input("To date (YYYY-MM-DD) or press Enter for no upper bound: ", to, sizeof(to));
+            generateDateRangeReport(choice == 10, from, to);
+        } else if (choice == 11) {
+            char buf[32];
+            read_line_input("How many mock students to register: ", buf, sizeof(buf));
+            long n = strtol(buf, NULL, 10);
+            if (n > 0) bulkRegisterMock((size_t)n);
+            else fprintf(stderr, "Invalid count.\n");
+        } else if (choice == 12 || choice == 13) {
+            char path[256];
+            read_line_input("CSV file path: ", path, sizeof(path));
+            if (choice == 12) importCSV(path);
+            else exportCSV(path);
         } else {
             printf("Unknown option.\n");
         }
+        // Whatever the command wrote is committed before the next prompt
+        if (commitWrites() != 0) {
+            fprintf(stderr, "Warning: could not commit changes to disk.\n");
+        }
     }
 
-    free(students);
-    students = NULL;
-    studentCapacity = 0;
-    studentCount = 0;
+    if (closeDatabase() != 0) {
+        fprintf(stderr, "Warning: could not checkpoint the id index.\n");
+    }
     printf("\nExiting program. Memory freed.\n");
-    return 0;
-}
\ No newline at end of file
+    return exitCode;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef PF_ASSIGNMENT3_TASK6_H
+#define PF_ASSIGNMENT3_TASK6_H
+
+// Membership database library. Build the program without its menu and
+// command-line front-end with -DPF_LIBRARY to link these functions into
+// another program. The database is members.dat in the current directory:
+// loadDatabase(DATAFILE) opens it and closeDatabase() commits and frees it.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DATAFILE "members.dat"
+#define NAME_LEN 100
+#define DATE_LEN 11
+
+// --- Data Structure ---
+typedef struct {
+    int id;                     
+    char name[NAME_LEN];        
+    char batch[32];             
+    char membership[8];         
+    char regDate[DATE_LEN];     
+    char dob[DATE_LEN];         
+    char interest[8];           
+} Student;
+
+// Results of the quiet db_* operations, also sent as the server's reply status
+enum { DB_OK = 0, DB_ERR_IO = -1, DB_ERR_EXISTS = -2, DB_ERR_NOT_FOUND = -3, DB_ERR_INVALID = -4 };
+
+// Receives each record a query matches. In paged mode the record is decoded
+// into a buffer reused for the next one, so copy it to keep it.
+typedef void (*StudentSink)(const Student *s, void *ctx);
+
+// A batch / membership change for db_update_batch; NULL or "" keeps the value
+typedef struct {
+    int id;
+    const char *batch;
+    const char *membership;
+} StudentUpdate;
+
+// Storage modes: a journal beside members.dat, records rewritten in place,
+// or paged from disk behind a buffer pool
+enum { STORAGE_JOURNAL, STORAGE_INPLACE, STORAGE_PAGED };
+
+int loadDatabase(const char *filename);
+int saveDatabase(const char *filename);
+int closeDatabase(void);
+
+// Single mutations and lookups; none of them print
+int db_add(const Student *s);
+int db_update(int studentID, const char *batch, const char *membership);
+int db_delete(int studentID);
+int db_get(int studentID, Student *out);
+
+// Batch versions: results[i] is the DB_* code of item i, and the whole call
+// is committed once at the end. Each returns how many items succeeded, or
+// -1 if they were applied but the commit failed.
+long db_add_batch(const Student *recs, int *results, size_t count);
+long db_update_batch(const StudentUpdate *updates, int *results, size_t count);
+long db_delete_batch(const int *ids, int *results, size_t count);
+long db_get_batch(const int *ids, Student *out, int *results, size_t count);
+
+// Queries: each hands the matching records to sink (unless it is NULL) and
+// returns how many matched, or DB_ERR_INVALID for a bad filter. Dates are
+// YYYY-MM-DD and an empty bound is open.
+size_t db_each(StudentSink sink, void *ctx);
+long db_batch_report(const char *batch, const char *filter, StudentSink sink, void *ctx);
+long db_date_range(int byDob, const char *from, const char *to, StudentSink sink, void *ctx);
+
+// Writes made between these are committed together; batches nest
+void beginBatch(void);
+int commitBatch(void);
+int commitWrites(void);
+
+// Printing versions used by the menu; updateStudent and
+// registerStudentInteractive read their input from stdin
+int addStudent(const Student *s);
+size_t addStudents(const Student *recs, size_t count);
+int updateStudent(int studentID);
+int deleteStudent(int studentID);
+void displayAllStudents(void);
+void generateBatchReport(const char *batchFilter, const char *membershipFilter);
+void generateDateRangeReport(int byDob, const char *from, const char *to);
+void registerStudentInteractive(void);
+void bulkRegisterMock(size_t count);
+long importCSV(const char *path);
+int exportCSV(const char *path);
+
+// --- Tools ---
+// Each returns 0 on success. The benchmark and the crash test run in a
+// scratch directory and discard the caller's in-memory database.
+enum { BENCH_ADD, BENCH_UPDATE, BENCH_DELETE, BENCH_LOOKUP, BENCH_REPORT, BENCH_OPS };
+enum { KEYS_UNIFORM, KEYS_ZIPF, KEYS_LATEST };
+
+typedef struct {
+    unsigned seed;
+    size_t records;             // preloaded before timing starts
+    size_t ops;                 // timed operations
+    unsigned mix[BENCH_OPS];    // relative weights
+    int keys;                   // KEYS_*
+    int inPlace;                // in-place storage instead of the journal
+    const char *output;         // JSON file, "-" for stdout
+} BenchConfig;
+
+int runBenchmark(const BenchConfig *cfg);
+int runCrashTest(unsigned seed, size_t records, size_t opCount, int storage, const char *output);
+int runServer(const char *socketPath, int threads);
+int runLoadGenerator(const char *socketPath, long requests, int connections, int readPercent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,526 @@
+// Benchmark suite for the hot functions of all six programs. Each program is
+// compiled into this file as a library (PF_LIBRARY leaves out its main), so
+// every function runs exactly as its program runs it; their console output
+// goes to /dev/null.
+//
+//     gcc -O2 -pthread pf-benchmarks.c -o pf-benchmarks -lm
+//     ./pf-benchmarks [-o results.json] [-r reps] [-w warmups] [-t ms] [-s seed] [-f filter]
+//
+// Every case runs on generated inputs at three sizes. Warm-up repetitions
+// also calibrate how many operations one repetition times (at least -t ms);
+// then -r repetitions are timed and summarised as nanoseconds per operation.
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#define PF_LIBRARY
+
+#include "pf-assignment3-task1.cpp"
+#include "pf-assignment3-task2.c"
+#include "pf-assignment3-task3.cpp"
+
+// pf-assignment3-task4.cpp is a copy of task 2's fuel program; the book shelf is q4
+#include "pf.assignment q4.c"
+
+// features.h has redefined _DEFAULT_SOURCE as 1 by now; task 5 defines it empty
+#undef _DEFAULT_SOURCE
+#include "pf-assignment3-task5.c"
+
+// Tasks 5 and 6 each size their first allocation from INITIAL_CAPACITY
+#undef INITIAL_CAPACITY
+#include "pf-assignment3-task6.c"
+
+#include <math.h>
+
+#define SUITE_DEFAULT_REPS 10
+#define SUITE_DEFAULT_WARMUP 2
+#define SUITE_DEFAULT_MIN_MS 20
+#define SUITE_MAX_REPS 1000
+#define SUITE_MAX_CALIBRATIONS 32
+#define SUITE_SEARCHES 256          // searchEmployee calls per repetition, read from one query file
+#define SUITE_LINE_FILE "bench-lines.txt"
+#define SUITE_QUERY_FILE "bench-queries.txt"
+
+// One benchmarked operation. Only run() is timed; before() and after()
+// bracket each repetition to give it a fresh state and may be NULL.
+typedef struct {
+    const char *program;
+    const char *function;
+    const char *unit;               // what the size counts
+    size_t sizes[3];
+    size_t fixedOps;                // 0: calibrated, else operations per repetition
+    void (*prepare)(size_t size);   // once per size
+    void (*before)(size_t ops);
+    void (*run)(size_t ops);
+    void (*after)(size_t ops);
+    void (*finish)(void);           // once per size, may be NULL
+} SuiteCase;
+
+typedef struct {
+    unsigned seed;
+    size_t reps, warmup;
+    double minMs;
+    const char *filter;
+    const char *output;
+} SuiteOptions;
+
+static unsigned suiteSeed = 1;
+static uint64_t suiteRng;
+static volatile double suiteSink;   // keeps results the compiler could otherwise drop
+static size_t suiteSize;
+
+// xorshift64*, seeded per case and size so every run sees the same inputs
+static uint64_t suite_rand(void) {
+    suiteRng ^= suiteRng >> 12;
+    suiteRng ^= suiteRng << 25;
+    suiteRng ^= suiteRng >> 27;
+    return suiteRng * 0x2545F4914F6CDD1Dull;
+}
+
+static void suite_seed(unsigned seed, size_t size) {
+    suiteRng = ((uint64_t)seed << 32 ^ size) * 0x9E3779B97F4A7C15ull | 1;
+    srand(seed ^ (unsigned)size);
+}
+
+// --- Task 1: loan repayment ---
+
+static void repayment_prepare(size_t years) {
+    suiteSize = years;
+}
+
+static void repayment_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) suiteSink += calculateRepayment(5000000.0, 0.05, (int)suiteSize, 1);
+}
+
+// --- Task 2: spacecraft fuel ---
+
+static void fuel_prepare(size_t planets) {
+    suiteSize = planets;
+}
+
+// Enough fuel for every planet, so each call recurses the whole way
+static void fuel_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) calculateFuel((int)suiteSize * 100, 50, 30, 20, 1, (int)suiteSize);
+}
+
+// --- Task 3: employee records ---
+
+static struct employeeInfo *suiteEmployees;
+static struct employeeInfo *suiteCopies;    // one fresh copy of the employees per updateSalary call
+static size_t suiteCopyCapacity;            // employees suiteCopies holds
+
+static void employees_finish(void) {
+    free(suiteEmployees);
+    free(suiteCopies);
+    suiteEmployees = NULL;
+    suiteCopies = NULL;
+    suiteCopyCapacity = 0;
+}
+
+static void employees_prepare(size_t count) {
+    static const char *const designations[] = { "Engineer", "Manager", "Analyst", "Intern" };
+    employees_finish();
+    suite_seed(suiteSeed, count);
+    suiteSize = count;
+    suiteEmployees = calloc(count, sizeof(*suiteEmployees));
+    if (!suiteEmployees) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        struct employeeInfo *e = &suiteEmployees[i];
+        e->id = (int)i + 1;
+        snprintf(e->name, sizeof(e->name), "Employee%zu", i + 1);
+        snprintf(e->designation, sizeof(e->designation), "%s", designations[suite_rand() % 4]);
+        e->salary = 20000.0f + (float)(suite_rand() % 80000);
+    }
+}
+
+static void highest_salary_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) findHighestSalary(suiteEmployees, (int)suiteSize);
+}
+
+// updateSalary raises salaries for good, so every call gets its own copy of
+// the employees as generated
+static void update_salary_before(size_t ops) {
+    if (ops * suiteSize > suiteCopyCapacity) {
+        free(suiteCopies);
+        suiteCopies = malloc(ops * suiteSize * sizeof(*suiteCopies));
+        if (!suiteCopies) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        suiteCopyCapacity = ops * suiteSize;
+    }
+    for (size_t i = 0; i < ops; ++i) {
+        memcpy(&suiteCopies[i * suiteSize], suiteEmployees, suiteSize * sizeof(*suiteCopies));
+    }
+}
+
+// About half the salaries start below the threshold
+static void update_salary_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) updateSalary(&suiteCopies[i * suiteSize], (int)suiteSize, 60000.0f);
+}
+
+// searchEmployee reads its queries from stdin: half by id, half by name, a tenth of each missing
+static void search_prepare(size_t count) {
+    employees_prepare(count);
+    FILE *f = fopen(SUITE_QUERY_FILE, "w");
+    if (!f) {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < SUITE_SEARCHES; ++i) {
+        size_t target = (size_t)(suite_rand() % (count + count / 9 + 1)) + 1;
+        if (i % 2 == 0) fprintf(f, "1 %zu\n", target);
+        else fprintf(f, "2 Employee%zu\n", target);
+    }
+    if (fclose(f) != 0 || !freopen(SUITE_QUERY_FILE, "r", stdin)) {
+        perror("freopen");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void search_before(size_t ops) {
+    (void)ops;
+    rewind(stdin);
+}
+
+static void search_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) searchEmployee(suiteEmployees, (int)suiteSize);
+}
+
+static void search_finish(void) {
+    employees_finish();
+    if (!freopen("/dev/null", "r", stdin)) perror("freopen");
+    remove(SUITE_QUERY_FILE);
+}
+
+// --- Task 4: library shelf ---
+
+static Book *suiteShelf;
+static int suiteShelfSize;
+static long suiteClock;
+
+static void shelf_finish(void) {
+    free(suiteShelf);
+    suiteShelf = NULL;
+}
+
+// A full shelf; later ids are drawn from twice its capacity, so half of them miss
+static void shelf_prepare(size_t capacity) {
+    shelf_finish();
+    suite_seed(suiteSeed, capacity);
+    suiteSize = capacity;
+    suiteShelf = malloc(capacity * sizeof(Book));
+    if (!suiteShelf) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    suiteShelfSize = 0;
+    suiteClock = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        add_book(suiteShelf, (int)capacity, &suiteShelfSize, (int)i, (int)(suite_rand() % 100), ++suiteClock);
+    }
+}
+
+static void add_book_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        int id = (int)(suite_rand() % (2 * suiteSize));
+        add_book(suiteShelf, (int)suiteSize, &suiteShelfSize, id, (int)(suite_rand() % 100), ++suiteClock);
+    }
+}
+
+static void access_book_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        suiteSink += access_book(suiteShelf, suiteShelfSize, (int)(suite_rand() % (2 * suiteSize)), ++suiteClock);
+    }
+}
+
+// --- Task 5: line editor ---
+
+static Editor suiteEditor;
+static int suiteEditorOpen;
+
+static void editor_finish(void) {
+    if (suiteEditorOpen) freeAll(&suiteEditor);
+    suiteEditorOpen = 0;
+    remove(SUITE_LINE_FILE);
+}
+
+// A file of `lines` lines of 20 to 99 characters, loaded into a fresh editor
+static void editor_prepare(size_t lines) {
+    editor_finish();
+    suite_seed(suiteSeed, lines);
+    suiteSize = lines;
+    FILE *f = fopen(SUITE_LINE_FILE, "w");
+    if (!f) {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < lines; ++i) {
+        size_t len = 20 + (size_t)(suite_rand() % 80);
+        for (size_t k = 0; k < len; ++k) fputc("abcdefghijklmnopqrstuvwxyz     "[suite_rand() % 31], f);
+        fputc('\n', f);
+    }
+    if (fclose(f) != 0) {
+        perror("fclose");
+        exit(EXIT_FAILURE);
+    }
+    initEditor(&suiteEditor);
+    suiteEditorOpen = 1;
+    if (loadFromFile(&suiteEditor, SUITE_LINE_FILE) != 0) exit(EXIT_FAILURE);
+}
+
+// One operation inserts a line and deletes another, so the buffer keeps its size
+static void insert_delete_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        insertLine(&suiteEditor, (size_t)(suite_rand() % (suiteSize + 1)), "the quick brown fox jumps over the lazy dog");
+        deleteLine(&suiteEditor, (size_t)(suite_rand() % (suiteSize + 1)));
+    }
+}
+
+static void load_file_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        if (loadFromFile(&suiteEditor, SUITE_LINE_FILE) != 0) exit(EXIT_FAILURE);
+    }
+}
+
+// --- Task 6: membership manager ---
+
+static Student *suiteStudents;      // registrations for the next repetition
+static size_t suiteStudentCapacity;
+static int suiteNextId;
+
+// `records` mock students registered as one batch into an empty members.dat
+static void members_prepare(size_t records) {
+    crash_clear();
+    remove(DATAFILE);
+    forget_database();
+    ensure_capacity(INITIAL_CAPACITY);
+    if (loadDatabase(DATAFILE) != 0) exit(EXIT_FAILURE);
+    suite_seed(suiteSeed, records);
+    suiteSize = records;
+    Student *chunk = malloc(BENCH_PRELOAD_CHUNK * sizeof(Student));
+    if (!chunk) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    beginBatch();
+    for (size_t done = 0; done < records; ) {
+        size_t n = records - done < BENCH_PRELOAD_CHUNK ? records - done : BENCH_PRELOAD_CHUNK;
+        for (size_t i = 0; i < n; ++i) chunk[i] = createMockStudent((int)(done + i) + 1);
+        addStudents(chunk, n);
+        done += n;
+    }
+    commitBatch();
+    free(chunk);
+    suiteNextId = (int)records + 1;
+}
+
+static void members_finish(void) {
+    forget_database();
+    free(suiteStudents);
+    suiteStudents = NULL;
+    suiteStudentCapacity = 0;
+}
+
+static void add_student_before(size_t ops) {
+    if (ops > suiteStudentCapacity) {
+        free(suiteStudents);
+        suiteStudents = malloc(ops * sizeof(Student));
+        if (!suiteStudents) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        suiteStudentCapacity = ops;
+    }
+    for (size_t i = 0; i < ops; ++i) suiteStudents[i] = createMockStudent(suiteNextId + (int)i);
+}
+
+static void add_student_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) addStudent(&suiteStudents[i]);
+}
+
+// Newest first, so each delete removes the last record and shifts nothing
+static void add_student_after(size_t ops) {
+    for (size_t i = ops; i-- > 0; ) deleteStudent(suiteNextId + (int)i);
+    commitWrites();
+}
+
+// Ids drawn from twice the table, so half of them miss
+static void find_student_run(size_t ops) {
+    for (size_t i = 0; i < ops; ++i) {
+        suiteSink += findStudentIndexByID((int)(suite_rand() % (2 * suiteSize)) + 1);
+    }
+}
+
+// One operation is all 16 batch and membership filter combinations
+static void batch_report_run(size_t ops) {
+    static const char *const batches[] = { "CS", "SE", "Cyber Security", "AI" };
+    static const char *const filters[] = { "", "IEEE", "ACM", "Both" };
+    for (size_t i = 0; i < ops; ++i) {
+        for (size_t k = 0; k < 16; ++k) generateBatchReport(batches[k % 4], filters[k / 4]);
+    }
+}
+
+static const SuiteCase suiteCases[] = {
+    { "pf-assignment3-task1.cpp", "calculateRepayment", "years", { 10, 100, 1000 }, 0,
+      repayment_prepare, NULL, repayment_run, NULL, NULL },
+    { "pf-assignment3-task2.c", "calculateFuel", "planets", { 12, 120, 1200 }, 0,
+      fuel_prepare, NULL, fuel_run, NULL, NULL },
+    { "pf-assignment3-task3.cpp", "findHighestSalary", "employees", { 100, 1000, 10000 }, 0,
+      employees_prepare, NULL, highest_salary_run, NULL, employees_finish },
+    { "pf-assignment3-task3.cpp", "updateSalary", "employees", { 100, 1000, 10000 }, 0,
+      employees_prepare, update_salary_before, update_salary_run, NULL, employees_finish },
+    { "pf-assignment3-task3.cpp", "searchEmployee", "employees", { 100, 1000, 10000 }, SUITE_SEARCHES,
+      search_prepare, search_before, search_run, NULL, search_finish },
+    { "pf.assignment q4.c", "add_book", "books", { 64, 1024, 16384 }, 0,
+      shelf_prepare, NULL, add_book_run, NULL, shelf_finish },
+    { "pf.assignment q4.c", "access_book", "books", { 64, 1024, 16384 }, 0,
+      shelf_prepare, NULL, access_book_run, NULL, shelf_finish },
+    { "pf-assignment3-task5.c", "insertLine+deleteLine", "lines", { 1000, 10000, 100000 }, 0,
+      editor_prepare, NULL, insert_delete_run, NULL, editor_finish },
+    { "pf-assignment3-task5.c", "loadFromFile", "lines", { 1000, 10000, 100000 }, 0,
+      editor_prepare, NULL, load_file_run, NULL, editor_finish },
+    { "pf-assignment3-task6.c", "addStudent", "records", { 1000, 10000, 100000 }, 0,
+      members_prepare, add_student_before, add_student_run, add_student_after, members_finish },
+    { "pf-assignment3-task6.c", "findStudentIndexByID", "records", { 1000, 10000, 100000 }, 0,
+      members_prepare, NULL, find_student_run, NULL, members_finish },
+    { "pf-assignment3-task6.c", "generateBatchReport", "records", { 1000, 10000, 100000 }, 0,
+      members_prepare, NULL, batch_report_run, NULL, members_finish },
+};
+
+// Runs one repetition of `ops` operations and returns the nanoseconds run() took
+static uint64_t suite_time(const SuiteCase *c, size_t ops) {
+    if (c->before) c->before(ops);
+    uint64_t start = bench_now_ns();
+    c->run(ops);
+    uint64_t elapsed = bench_now_ns() - start;
+    fflush(stdout);
+    if (c->after) c->after(ops);
+    return elapsed;
+}
+
+static int suite_double_cmp(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Warms up and calibrates one case at one size, times it and writes its JSON object
+static void suite_measure(const SuiteCase *c, size_t size, const SuiteOptions *opt, FILE *out, int first) {
+    c->prepare(size);
+    size_t ops = c->fixedOps ? c->fixedOps : 1;
+    uint64_t minNs = (uint64_t)(opt->minMs * 1e6);
+    for (size_t w = 0; w < opt->warmup || (!c->fixedOps && w < SUITE_MAX_CALIBRATIONS); ++w) {
+        uint64_t ns = suite_time(c, ops);
+        if (c->fixedOps || ns >= minNs) {
+            if (w + 1 >= opt->warmup) break;
+            continue;
+        }
+        // Aim a little past the target, but never grow more than 100x on one sample
+        size_t next = ns > 0 ? (size_t)((double)ops * minNs * 1.2 / ns) : ops * 100;
+        ops = next > ops * 100 ? ops * 100 : next > ops ? next : ops + 1;
+    }
+
+    double *samples = malloc(opt->reps * sizeof(double));
+    if (!samples) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    double sum = 0.0;
+    for (size_t r = 0; r < opt->reps; ++r) {
+        samples[r] = (double)suite_time(c, ops) / ops;
+        sum += samples[r];
+    }
+    if (c->finish) c->finish();
+
+    double mean = sum / opt->reps, var = 0.0;
+    for (size_t r = 0; r < opt->reps; ++r) var += (samples[r] - mean) * (samples[r] - mean);
+    qsort(samples, opt->reps, sizeof(double), suite_double_cmp);
+    double median = opt->reps % 2 ? samples[opt->reps / 2]
+                                  : (samples[opt->reps / 2 - 1] + samples[opt->reps / 2]) / 2;
+    fprintf(out, "%s    {\"program\": \"%s\", \"function\": \"%s\", \"size\": %zu, \"unit\": \"%s\", "
+                 "\"ops_per_repetition\": %zu, \"ns_per_op\": {\"min\": %.1f, \"median\": %.1f, \"mean\": %.1f, "
+                 "\"stddev\": %.1f, \"max\": %.1f}}",
+            first ? "" : ",\n", c->program, c->function, size, c->unit, ops,
+            samples[0], median, mean, opt->reps > 1 ? sqrt(var / (opt->reps - 1)) : 0.0,
+            samples[opt->reps - 1]);
+    fflush(out);
+    free(samples);
+}
+
+static void suite_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-o results.json] [-r reps] [-w warmups] [-t ms] [-s seed] [-f filter]\n", prog);
+    fprintf(stderr, "  -o  JSON results to this file (default - for stdout)\n");
+    fprintf(stderr, "  -r  timed repetitions per case and size (default %d)\n", SUITE_DEFAULT_REPS);
+    fprintf(stderr, "  -w  warm-up repetitions, which also calibrate the operations per repetition (default %d)\n",
+            SUITE_DEFAULT_WARMUP);
+    fprintf(stderr, "  -t  shortest calibrated repetition in milliseconds (default %d)\n", SUITE_DEFAULT_MIN_MS);
+    fprintf(stderr, "  -s  seed for the generated inputs (default 1)\n");
+    fprintf(stderr, "  -f  run only cases whose \"file function\" name contains this text\n");
+}
+
+int main(int argc, char **argv) {
+    SuiteOptions opt = { 1, SUITE_DEFAULT_REPS, SUITE_DEFAULT_WARMUP, SUITE_DEFAULT_MIN_MS, NULL, "-" };
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            opt.output = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            opt.reps = (size_t)atol(argv[++i]);
+            if (opt.reps < 1 || opt.reps > SUITE_MAX_REPS) { suite_usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            long warmup = atol(argv[++i]);
+            if (warmup < 0) { suite_usage(argv[0]); return EXIT_FAILURE; }
+            opt.warmup = (size_t)warmup;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            opt.minMs = atof(argv[++i]);
+            if (opt.minMs <= 0) { suite_usage(argv[0]); return EXIT_FAILURE; }
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            opt.seed = (unsigned)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            opt.filter = argv[++i];
+        } else {
+            suite_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    suiteSeed = opt.seed;
+
+    // Results go to the real stdout or file; the programs' own output does not
+    FILE *out = strcmp(opt.output, "-") == 0 ? fdopen(dup(STDOUT_FILENO), "w") : fopen(opt.output, "w");
+    if (!out) {
+        perror("fopen");
+        fprintf(stderr, "Error: could not open '%s' for benchmark results.\n", opt.output);
+        return EXIT_FAILURE;
+    }
+    char dir[] = "pf-bench-XXXXXX";
+    if (scratch_enter(dir) != 0) {
+        fclose(out);
+        return EXIT_FAILURE;
+    }
+    int savedOut = silence(STDOUT_FILENO);
+
+    fprintf(out, "{\n  \"suite\": \"pf-benchmarks\",\n  \"compiler\": \"%s\",\n  \"seed\": %u,\n"
+                 "  \"warmup\": %zu,\n  \"repetitions\": %zu,\n  \"min_repetition_ms\": %.1f,\n  \"results\": [\n",
+            __VERSION__, opt.seed, opt.warmup, opt.reps, opt.minMs);
+    int first = 1;
+    for (size_t k = 0; k < NAME_COUNT(suiteCases); ++k) {
+        const SuiteCase *c = &suiteCases[k];
+        char name[128];
+        snprintf(name, sizeof(name), "%s %s", c->program, c->function);
+        if (opt.filter && !strstr(name, opt.filter)) continue;
+        for (size_t j = 0; j < NAME_COUNT(c->sizes); ++j) {
+            fprintf(stderr, "Benchmark: %s, %zu %s...\n", name, c->sizes[j], c->unit);
+            suite_measure(c, c->sizes[j], &opt, out, first);
+            first = 0;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    unsilence(STDOUT_FILENO, savedOut);
+    scratch_leave(dir);
+    if (fclose(out) != 0) {
+        perror("fclose");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
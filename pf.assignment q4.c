@@ -1,12 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-typedef struct {
-    int id;
-    int popularity;
-    long lastAccessed;  
-} Book;
+#include "pf.assignment q4.h"
 
 int find_book_index(Book *shelf, int size, int id) {
     for (int i = 0; i < size; i++) {
@@ -63,6 +58,22 @@ int access_book(Book *shelf, int size, int id, long currentTime) {
     return shelf[index].popularity;
 }
 
+void run_book_ops(Book *shelf, int capacity, int *sizeofPtr, long *clockPtr,
+                  const BookOp *ops, int *results, size_t count) {
+    long now = *clockPtr;
+    for (size_t i = 0; i < count; i++) {
+        now++;
+        if (ops[i].kind == BOOK_ADD) {
+            add_book(shelf, capacity, sizeofPtr, ops[i].id, ops[i].popularity, now);
+            results[i] = 0;
+        } else {
+            results[i] = access_book(shelf, *sizeofPtr, ops[i].id, now);
+        }
+    }
+    *clockPtr = now;
+}
+
+#ifndef PF_LIBRARY
 int main() {
 
     int capacity, Q;
@@ -90,28 +101,31 @@ int main() {
             break;
         }
 
+        BookOp request;
+        int result;
+
         if (strcmp(op, "ADD") == 0) {
 
-            int id, pop;
-            if (scanf("%d %d", &id, &pop) != 2) {
+            request.kind = BOOK_ADD;
+            if (scanf("%d %d", &request.id, &request.popularity) != 2) {
                 fprintf(stderr, "ADD format is incorrect!\n");
                 continue;
             }
 
-            timeCounter++;
-            add_book(shelf, capacity, &currentSize, id, pop, timeCounter);
+            run_book_ops(shelf, capacity, &currentSize, &timeCounter, &request, &result, 1);
         }
 
         else if (strcmp(op, "ACCESS") == 0) {
 
-            int id;
-            if (scanf("%d", &id) != 1) {
+            request.kind = BOOK_ACCESS;
+            request.popularity = 0;
+            if (scanf("%d", &request.id) != 1) {
                 fprintf(stderr, "ACCESS format is incorrect!\n");
                 continue;
             }
 
-            timeCounter++;
-            printf("%d\n", access_book(shelf, currentSize, id, timeCounter));
+            run_book_ops(shelf, capacity, &currentSize, &timeCounter, &request, &result, 1);
+            printf("%d\n", result);
         }
 
         else {
@@ -122,3 +136,4 @@ int main() {
     free(shelf);
     return 0;
 }
+#endif
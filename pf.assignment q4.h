@@ -0,0 +1,41 @@
+#ifndef PF_ASSIGNMENT_Q4_H
+#define PF_ASSIGNMENT_Q4_H
+
+// Library shelf with least-recently-accessed eviction. Build the program
+// without its command reader with -DPF_LIBRARY to link these functions
+// into another program. None of them print.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int id;
+    int popularity;
+    long lastAccessed;  
+} Book;
+
+typedef enum { BOOK_ADD, BOOK_ACCESS } BookOpKind;
+
+typedef struct {
+    BookOpKind kind;
+    int id;
+    int popularity;     // ADD only
+} BookOp;
+
+int find_book_index(Book *shelf, int size, int id);
+void add_book(Book *shelf, int capacity, int *sizeofPtr, int id, int popularity, long currentTime);
+int access_book(Book *shelf, int size, int id, long currentTime);
+
+// applies ops in order, each one tick after *clockPtr; results[i] is the
+// popularity an ACCESS returned (-1 if absent) and 0 for an ADD
+void run_book_ops(Book *shelf, int capacity, int *sizeofPtr, long *clockPtr,
+                  const BookOp *ops, int *results, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif